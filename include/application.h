@@ -3,6 +3,8 @@
 #include "window.h"
 #include "renderer.h"
 #include "board.h"
+#include "board_view.h"
+#include "engine.h"
 
 class Application
 {
@@ -10,6 +12,8 @@ public:
     Window window = Window("Chess", 1440, 900);
     Renderer renderer = Renderer("../src/shaders/vertex.glsl", "../src/shaders/fragment.glsl", window, "../src/shaders/pieceVert.glsl", "../src/shaders/pieceFrag.glsl");
     Board board;
+    BoardView view = BoardView(board);
+    Engine engine;
 
     void run()
     {
@@ -18,12 +22,13 @@ public:
         while(!glfwWindowShouldClose(window.window))
         {
             window.processInput();
-            board.updateAnimation(window.deltaTime);
+            view.updateAnimation(window.deltaTime, engine);
 
-            if(!board.isAnimating)
+            // Input is ignored while the engine thinks, the frame loop just keeps rendering
+            if(!view.isAnimating && !view.waitingForEngine)
             {
-                board.handleInput(window, renderer.smallestDimension);
-                //board.moveComputer(true);
+                view.handleInput(window, renderer.smallestDimension);
+                //view.moveComputer(true, engine);
 
                 if(board.checkmate >= 0)
                 {
@@ -37,8 +42,8 @@ public:
                         std::cout << "MATE FOR WHITE" << std::endl;
                 }
 
-                //board.handleInput(window, renderer.smallestDimension);
-                board.moveComputer(false);
+                //view.handleInput(window, renderer.smallestDimension);
+                view.moveComputer(false, engine);
 
                 if (board.checkmate >= 0)
                 {
@@ -54,8 +59,8 @@ public:
             }
 
             renderer.beginFrame();
-            renderer.render(window, board);
-            board.drawPieces(renderer, window);
+            renderer.render(window, view);
+            view.drawPieces(renderer, window);
             window.update();
         }
     }
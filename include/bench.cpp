@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "bench.h"
+#include "board.h"
+#include "search.h"
+#include "Stopwatch.h"
+#include "transposition_table.h"
+
+uint64_t Bench::run(int depth)
+{
+    // Single threaded, default hash size and no progress output, whatever the UCI options say.
+    // Node counts depend on all three. Everything is restored afterwards
+    const int threads = Searcher.threadCount();
+    const size_t hashMB = TT.sizeMB();
+    auto onIteration = Searcher.onIteration;
+    Searcher.setThreads(1);
+    Searcher.onIteration = nullptr;
+    TT.resize(TranspositionTable::DefaultSizeMB);
+
+    const int count = sizeof(positions) / sizeof(positions[0]);
+
+    Board board;
+    Stopwatch sw;
+    uint64_t totalNodes = 0;
+    uint64_t cutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+
+    // FNV-1a over every position's node count and best move
+    uint64_t signature = 0xCBF29CE484222325ULL;
+    auto mix = [&signature](uint64_t value)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            signature ^= (value >> (i * 8)) & 0xFF;
+            signature *= 0x100000001B3ULL;
+        }
+    };
+
+    SearchLimits limits;
+    limits.depth = depth;
+
+    sw.start();
+
+    for (int i = 0; i < count; i++)
+    {
+        board.loadFen(positions[i]);
+        TT.clear();
+
+        const Move bestMove = Searcher.go(board, limits);
+        const uint64_t nodes = Searcher.nodes();
+
+        totalNodes += nodes;
+        cutoffs += Searcher.bestWorker().cutoffs;
+        firstMoveCutoffs += Searcher.bestWorker().firstMoveCutoffs;
+        mix(nodes);
+        mix(bestMove.data);
+
+        std::cout << "Position " << std::setw(2) << i + 1 << "/" << count << ": " << std::setw(5)
+                  << board.moveToUci(bestMove) << " " << std::setw(10) << nodes << " nodes" << std::endl;
+    }
+
+    sw.stop();
+
+    const long long ms = std::max(sw.getElapsedTimeMilliseconds(), 1LL);
+
+    std::cout << "==========================" << std::endl;
+    std::cout << "Depth          : " << depth << std::endl;
+    std::cout << "Total time (ms): " << ms << std::endl;
+    std::cout << "Nodes searched : " << totalNodes << std::endl;
+    std::cout << "Nodes/second   : " << totalNodes * 1000 / ms << std::endl;
+    std::cout << "First move cuts: " << std::fixed << std::setprecision(1)
+              << 100.0 * firstMoveCutoffs / std::max<uint64_t>(cutoffs, 1) << "%" << std::endl;
+    std::cout << "Signature      : " << std::hex << std::setw(16) << std::setfill('0') << signature
+              << std::dec << std::setfill(' ') << std::endl;
+
+    Searcher.setThreads(threads);
+    Searcher.onIteration = onIteration;
+    TT.resize(hashMB);
+
+    return signature;
+}
@@ -0,0 +1,173 @@
+#include "bitboard.h"
+#include "move_generator.h"
+
+namespace
+{
+    // Magic numbers for a collision-free index into each square's attack table slice
+    constexpr Bitboard RookMagicNumbers[64] = {
+        0x8080102040008000ULL, 0x5440041000200048ULL, 0x008020008010000AULL, 0x0200084200100420ULL,
+        0x0200081020040200ULL, 0x0600019002002824ULL, 0x040050811008020CULL, 0x0100004881000126ULL,
+        0x0005800440008020ULL, 0x2882002042090880ULL, 0x0002802000801004ULL, 0x0240808010000800ULL,
+        0x4480800800040082ULL, 0x0408808004000200ULL, 0x00BA0004A8020001ULL, 0x1106000042040091ULL,
+        0x0020208010400080ULL, 0x0022060045028020ULL, 0x0020008020100080ULL, 0x0202020008102041ULL,
+        0x0C50808008000400ULL, 0x0068808002000400ULL, 0x00510400C8100201ULL, 0x400006000100A444ULL,
+        0x483424818008400AULL, 0x8840008080200040ULL, 0x0800100080802000ULL, 0x0440100080800800ULL,
+        0x4000080080040080ULL, 0x9124040080020080ULL, 0x0089000300040E00ULL, 0x080001020020488CULL,
+        0x9040002040800080ULL, 0x80D0002001400242ULL, 0x0000401901002002ULL, 0x0030220901001000ULL,
+        0x0080580005003100ULL, 0x0022006C0A001008ULL, 0x0802301144001248ULL, 0x0020010042000084ULL,
+        0x4AC0400084228004ULL, 0x0010004020004000ULL, 0x3110004020010100ULL, 0x0598100009050020ULL,
+        0x4200080011010004ULL, 0x0818020004008080ULL, 0x02A0708102040008ULL, 0x5201010080420004ULL,
+        0x100B124063800100ULL, 0x7808200240048980ULL, 0x8800200010008080ULL, 0x1099201001000900ULL,
+        0x0100050010080100ULL, 0x0400800200040080ULL, 0x2040280190020400ULL, 0x00100C0100608200ULL,
+        0x0000201241088202ULL, 0x1040002042801B01ULL, 0x0124090010200041ULL, 0x0831002004081001ULL,
+        0x2003000800021005ULL, 0x80010002040008C1ULL, 0x0208008122081004ULL, 0x4000008844002102ULL};
+
+    constexpr Bitboard BishopMagicNumbers[64] = {
+        0x0020011019010028ULL, 0x0122100912208000ULL, 0x1498082308200080ULL, 0x0004106600000000ULL,
+        0x2082021000405600ULL, 0x68508804C0820201ULL, 0xA004140422080010ULL, 0x0120402084202004ULL,
+        0x0000F0101014C080ULL, 0x014002300A022041ULL, 0x000084080A004020ULL, 0x2061949202010083ULL,
+        0x0407820210050008ULL, 0x00500101084008A2ULL, 0x2000040404420880ULL, 0x00090044041C0710ULL,
+        0x0804004030841140ULL, 0x002580A001240100ULL, 0x2081000214090200ULL, 0x0812022C01220050ULL,
+        0x0602001012100010ULL, 0x0003004080454024ULL, 0x0000400088084800ULL, 0x8000800040480850ULL,
+        0x1010040110602230ULL, 0x8428204002044D32ULL, 0x0340240028880200ULL, 0x1804080018220040ULL,
+        0x0C10101041004001ULL, 0x0422208008080100ULL, 0x0010810610941000ULL, 0x0302122002050140ULL,
+        0x8304104008054400ULL, 0x1000AC5003A45026ULL, 0x0202402080100508ULL, 0xC801042008040100ULL,
+        0x00400020210A0080ULL, 0x4010404200004104ULL, 0x0401180120008C00ULL, 0x0811450200110052ULL,
+        0xB10110825000A020ULL, 0x8104008405001050ULL, 0x0908094050030803ULL, 0x000414C204800804ULL,
+        0x2000202414004042ULL, 0x044001040020A100ULL, 0x0008100400440082ULL, 0x210101050A040102ULL,
+        0x8004442420080000ULL, 0x0906008421080000ULL, 0x0220208048081004ULL, 0x0000004084240800ULL,
+        0x00080020A0864200ULL, 0x40010484880E0000ULL, 0x9040100440808008ULL, 0x0010028089020002ULL,
+        0x100082004202C000ULL, 0x4049051042022000ULL, 0x010100010C110400ULL, 0x8200000B02208810ULL,
+        0x0000001008210100ULL, 0x0000180410241840ULL, 0x0880100401680A01ULL, 0x04021A0809040081ULL};
+
+    Bitboard rookTable[0x19000];
+    Bitboard bishopTable[0x1480];
+
+    // Slow ray-walking attacks, only used to fill the magic tables
+    Bitboard slidingAttacks(int square, Bitboard occupied, int firstDirection, int lastDirection)
+    {
+        using namespace Bitboards;
+
+        Bitboard attacks = 0;
+
+        for (int direction = firstDirection; direction < lastDirection; direction++)
+        {
+            Bitboard ray = rays[direction][square];
+            const Bitboard blockers = ray & occupied;
+
+            // Cut the ray off behind the first piece it runs into
+            if (blockers)
+            {
+                const int blocker = MoveGen::directionOffsets[direction] > 0 ? lsb(blockers) : msb(blockers);
+                ray ^= rays[direction][blocker];
+            }
+
+            attacks |= ray;
+        }
+
+        return attacks;
+    }
+
+    // Blocker squares that matter for a slider: its rays minus the final square on each (edge squares never block)
+    Bitboard relevantMask(int square, int firstDirection, int lastDirection)
+    {
+        using namespace Bitboards;
+
+        Bitboard mask = 0;
+
+        for (int direction = firstDirection; direction < lastDirection; direction++)
+        {
+            Bitboard ray = rays[direction][square];
+
+            if (ray)
+                ray ^= squareBB(MoveGen::directionOffsets[direction] > 0 ? msb(ray) : lsb(ray));
+
+            mask |= ray;
+        }
+
+        return mask;
+    }
+
+    void initMagics(std::array<Bitboards::Magic, 64> &magics, Bitboard *table, const Bitboard *magicNumbers,
+                    int firstDirection, int lastDirection)
+    {
+        Bitboard *slice = table;
+
+        for (int square = 0; square < 64; square++)
+        {
+            Bitboards::Magic &m = magics[square];
+            m.mask = relevantMask(square, firstDirection, lastDirection);
+            m.magic = magicNumbers[square];
+            m.shift = 64 - Bitboards::popCount(m.mask);
+            m.attacks = slice;
+
+            // Carry-Rippler trick to enumerate every subset of the mask
+            Bitboard subset = 0;
+            do
+            {
+                m.attacks[m.index(subset)] = slidingAttacks(square, subset, firstDirection, lastDirection);
+                subset = (subset - m.mask) & m.mask;
+            } while (subset);
+
+            slice += 1ULL << Bitboards::popCount(m.mask);
+        }
+    }
+}
+
+// Expects MoveGen::numSquaresToEdge to be filled in already (see MoveGen::precomputeMoveData)
+void Bitboards::init()
+{
+    for (int square = 0; square < 64; square++)
+    {
+        const Bitboard b = squareBB(square);
+
+        knightAttacks[square] =
+            ((b & ~FileH) << 17) | ((b & ~FileA) << 15) |
+            ((b & ~(FileH | (FileH >> 1))) << 10) | ((b & ~(FileA | (FileA << 1))) << 6) |
+            ((b & ~(FileH | (FileH >> 1))) >> 6) | ((b & ~(FileA | (FileA << 1))) >> 10) |
+            ((b & ~FileH) >> 15) | ((b & ~FileA) >> 17);
+
+        kingAttacks[square] =
+            shiftNorth(b) | shiftSouth(b) |
+            ((b & ~FileA) >> 1) | ((b & ~FileH) << 1) |
+            shiftNorthEast(b) | shiftNorthWest(b) | shiftSouthEast(b) | shiftSouthWest(b);
+
+        pawnAttacks[White][square] = shiftNorthEast(b) | shiftNorthWest(b);
+        pawnAttacks[Black][square] = shiftSouthEast(b) | shiftSouthWest(b);
+
+        for (int direction = 0; direction < MoveGen::DirectionCount; direction++)
+        {
+            Bitboard ray = 0;
+
+            for (int n = 1; n <= MoveGen::numSquaresToEdge[square][direction]; n++)
+                ray |= squareBB(square + MoveGen::directionOffsets[direction] * n);
+
+            rays[direction][square] = ray;
+        }
+    }
+
+    initMagics(rookMagics, rookTable, RookMagicNumbers, 0, 4);
+    initMagics(bishopMagics, bishopTable, BishopMagicNumbers, 4, 8);
+
+    for (int from = 0; from < 64; from++)
+    {
+        for (int to = 0; to < 64; to++)
+        {
+            const Bitboard ends = squareBB(from) | squareBB(to);
+
+            if (from == to)
+                continue;
+
+            if (attacks<Rook>(from, 0) & squareBB(to))
+            {
+                lineBB[from][to] = (attacks<Rook>(from, 0) & attacks<Rook>(to, 0)) | ends;
+                betweenBB[from][to] = attacks<Rook>(from, squareBB(to)) & attacks<Rook>(to, squareBB(from));
+            }
+            else if (attacks<Bishop>(from, 0) & squareBB(to))
+            {
+                lineBB[from][to] = (attacks<Bishop>(from, 0) & attacks<Bishop>(to, 0)) | ends;
+                betweenBB[from][to] = attacks<Bishop>(from, squareBB(to)) & attacks<Bishop>(to, squareBB(from));
+            }
+        }
+    }
+}
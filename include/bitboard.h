@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+
+#include "piece.h"
+
+#if defined(USE_PEXT)
+#if !defined(__BMI2__)
+#error "USE_PEXT needs a BMI2 target, build with -mbmi2 or -march=native on a BMI2 CPU"
+#endif
+#include <immintrin.h>
+#endif
+
+using Bitboard = uint64_t;
+
+enum Colour
+{
+    White = 0,
+    Black = 1,
+};
+
+namespace Bitboards
+{
+    inline constexpr Bitboard FileA = 0x0101010101010101ULL;
+    inline constexpr Bitboard FileH = FileA << 7;
+
+    inline constexpr Bitboard Rank1 = 0xFFULL;
+    inline constexpr Bitboard Rank2 = Rank1 << 8;
+    inline constexpr Bitboard Rank3 = Rank1 << 16;
+    inline constexpr Bitboard Rank6 = Rank1 << 40;
+    inline constexpr Bitboard Rank7 = Rank1 << 48;
+    inline constexpr Bitboard Rank8 = Rank1 << 56;
+
+    inline constexpr Bitboard squareBB(int square) { return 1ULL << square; }
+
+    inline int popCount(Bitboard b) { return __builtin_popcountll(b); }
+
+    // Index of the least / most significant set bit. b must be non-zero.
+    inline int lsb(Bitboard b) { return __builtin_ctzll(b); }
+    inline int msb(Bitboard b) { return 63 ^ __builtin_clzll(b); }
+
+    inline int popLsb(Bitboard &b)
+    {
+        const int square = lsb(b);
+        b &= b - 1;
+        return square;
+    }
+
+    // Shift every square of the set one step, dropping squares that would wrap around a file edge
+    inline constexpr Bitboard shiftNorth(Bitboard b) { return b << 8; }
+    inline constexpr Bitboard shiftSouth(Bitboard b) { return b >> 8; }
+    inline constexpr Bitboard shiftNorthEast(Bitboard b) { return (b & ~FileH) << 9; }
+    inline constexpr Bitboard shiftNorthWest(Bitboard b) { return (b & ~FileA) << 7; }
+    inline constexpr Bitboard shiftSouthEast(Bitboard b) { return (b & ~FileH) >> 7; }
+    inline constexpr Bitboard shiftSouthWest(Bitboard b) { return (b & ~FileA) >> 9; }
+
+    // --- PRECOMPUTED DATA ---
+    inline std::array<Bitboard, 64> knightAttacks{};
+    inline std::array<Bitboard, 64> kingAttacks{};
+    inline std::array<std::array<Bitboard, 64>, 2> pawnAttacks{}; // [colour][square]
+
+    // Squares seen from a square in each MoveGen::directionOffsets direction on an empty board
+    inline std::array<std::array<Bitboard, 64>, 8> rays{};
+
+    // Slider attacks are looked up by hashing the relevant blockers with a per-square magic number,
+    // or with USE_PEXT by packing them into a dense index with the BMI2 PEXT instruction
+    struct Magic
+    {
+        Bitboard mask;     // Squares whose occupancy can block the slider (board edges excluded)
+        Bitboard magic;    // Unused with USE_PEXT
+        Bitboard *attacks; // This square's slice of the shared attack table
+        unsigned shift;
+
+        unsigned index(Bitboard occupied) const
+        {
+#if defined(USE_PEXT)
+            return unsigned(_pext_u64(occupied, mask));
+#else
+            return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+        }
+    };
+
+    inline std::array<Magic, 64> rookMagics{};
+    inline std::array<Magic, 64> bishopMagics{};
+
+    // For two squares on a common rank, file or diagonal: the squares strictly between them,
+    // and the whole edge-to-edge line through both. Empty when the squares aren't aligned
+    inline std::array<std::array<Bitboard, 64>, 64> betweenBB{};
+    inline std::array<std::array<Bitboard, 64>, 64> lineBB{};
+
+    void init();
+
+    // Squares attacked by a piece of the given type on square. Pawns are colour dependent, use pawnAttacks
+    template <PieceType Type>
+    inline Bitboard attacks(int square, Bitboard occupied)
+    {
+        static_assert(Type != Pawn && Type != None, "pawn attacks depend on colour");
+
+        if constexpr (Type == Knight)
+            return knightAttacks[square];
+        else if constexpr (Type == King)
+            return kingAttacks[square];
+        else if constexpr (Type == Rook)
+        {
+            const Magic &m = rookMagics[square];
+            return m.attacks[m.index(occupied)];
+        }
+        else if constexpr (Type == Bishop)
+        {
+            const Magic &m = bishopMagics[square];
+            return m.attacks[m.index(occupied)];
+        }
+        else
+            return attacks<Rook>(square, occupied) | attacks<Bishop>(square, occupied);
+    }
+
+    // Runtime-type version for generic code, e.g. looping over piece types
+    inline Bitboard attacks(PieceType type, int square, Bitboard occupied)
+    {
+        switch (type)
+        {
+        case Knight:
+            return attacks<Knight>(square, occupied);
+        case Bishop:
+            return attacks<Bishop>(square, occupied);
+        case Rook:
+            return attacks<Rook>(square, occupied);
+        case Queen:
+            return attacks<Queen>(square, occupied);
+        case King:
+            return attacks<King>(square, occupied);
+        default:
+            return 0;
+        }
+    }
+};
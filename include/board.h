@@ -1,570 +1,654 @@
 #pragma once
 
-#include "window.h"
 #include "piece.h"
 #include "move_generator.h"
+#include "bitboard.h"
+#include "zobrist.h"
 
+#include <array>
 #include <iostream>
 #include <algorithm>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <cstdlib>
 
-struct PieceList
-{
-    std::vector<int> whitePawns;
-    std::vector<int> whiteKnights;
-    std::vector<int> whiteBishops;
-    std::vector<int> whiteRooks;
-    std::vector<int> whiteQueens;
-    int whiteKing = -1;
-
-    std::vector<int> blackPawns;
-    std::vector<int> blackKnights;
-    std::vector<int> blackBishops;
-    std::vector<int> blackRooks;
-    std::vector<int> blackQueens;
-    int blackKing = -1;
-
-    void clear()
-    {
-        whitePawns.clear();
-        whiteKnights.clear();
-        whiteBishops.clear();
-        whiteRooks.clear();
-        whiteQueens.clear();
-        blackPawns.clear();
-        blackKnights.clear();
-        blackBishops.clear();
-        blackRooks.clear();
-        blackQueens.clear();
-        whiteKing = -1;
-        blackKing = -1;
-    }
-
-    void addPiece(PieceType type, bool isWhite, int square)
-    {
-        if (isWhite)
-        {
-            switch (type)
-            {
-            case Pawn:
-                whitePawns.push_back(square);
-                break;
-            case Knight:
-                whiteKnights.push_back(square);
-                break;
-            case Bishop:
-                whiteBishops.push_back(square);
-                break;
-            case Rook:
-                whiteRooks.push_back(square);
-                break;
-            case Queen:
-                whiteQueens.push_back(square);
-                break;
-            case King:
-                whiteKing = square;
-                break;
-            default:
-                break;
-            }
-        }
-        else
-        {
-            switch (type)
-            {
-            case Pawn:
-                blackPawns.push_back(square);
-                break;
-            case Knight:
-                blackKnights.push_back(square);
-                break;
-            case Bishop:
-                blackBishops.push_back(square);
-                break;
-            case Rook:
-                blackRooks.push_back(square);
-                break;
-            case Queen:
-                blackQueens.push_back(square);
-                break;
-            case King:
-                blackKing = square;
-                break;
-            default:
-                break;
-            }
-        }
-    }
-
-    // OPTIMIZED: Swap-and-pop instead of erase-remove
-    void removePiece(PieceType type, bool isWhite, int square)
-    {
-        std::vector<int> *list = getPieceList(type, isWhite);
-        if (!list)
-            return;
-
-        // Find the square and swap with last element, then pop
-        for (size_t i = 0; i < list->size(); i++)
-        {
-            if ((*list)[i] == square)
-            {
-                (*list)[i] = list->back();
-                list->pop_back();
-                return;
-            }
-        }
-    }
-
-    // OPTIMIZED: Direct update instead of find-and-replace
-    void movePiece(PieceType type, bool isWhite, int from, int to)
-    {
-        if (type == King)
-        {
-            if (isWhite)
-                whiteKing = to;
-            else
-                blackKing = to;
-            return;
-        }
+// Search scores. A mate in n plies scores MateScore - n, and every score fits in the TT's 16 bits
+inline constexpr int MaxPly = 128;
+inline constexpr int MateScore = 32000;
+inline constexpr int MateThreshold = MateScore - MaxPly;
+inline constexpr int InfinityScore = 32001;
 
-        std::vector<int> *list = getPieceList(type, isWhite);
-        if (!list)
-            return;
+// Deepest iteration the search will start when the clock allows it
+inline constexpr int MaxSearchDepth = 64;
 
-        // Swap-based move
-        for (size_t i = 0; i < list->size(); i++)
-        {
-            if ((*list)[i] == from)
-            {
-                (*list)[i] = to;
-                return;
-            }
-        }
-    }
+inline const char *StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
-private:
-    std::vector<int> *getPieceList(PieceType type, bool isWhite)
-    {
-        if (isWhite)
-        {
-            switch (type)
-            {
-            case Pawn:
-                return &whitePawns;
-            case Knight:
-                return &whiteKnights;
-            case Bishop:
-                return &whiteBishops;
-            case Rook:
-                return &whiteRooks;
-            case Queen:
-                return &whiteQueens;
-            default:
-                return nullptr;
-            }
-        }
-        else
-        {
-            switch (type)
-            {
-            case Pawn:
-                return &blackPawns;
-            case Knight:
-                return &blackKnights;
-            case Bishop:
-                return &blackBishops;
-            case Rook:
-                return &blackRooks;
-            case Queen:
-                return &blackQueens;
-            default:
-                return nullptr;
-            }
-        }
-    }
+enum CastlingRights
+{
+    WhiteKingside = 1,
+    WhiteQueenside = 2,
+    BlackKingside = 4,
+    BlackQueenside = 8,
+    AllCastling = 15,
 };
 
-class Renderer;
+// Castling rights that survive a move touching each square: moving or capturing
+// on a king or rook home square clears the rights that depend on it
+inline constexpr std::array<int, 64> castlingRightsMask = []
+{
+    std::array<int, 64> mask{};
+    for (int &m : mask)
+        m = AllCastling;
+
+    mask[0] = AllCastling & ~WhiteQueenside;                    // a1
+    mask[4] = AllCastling & ~(WhiteKingside | WhiteQueenside);  // e1
+    mask[7] = AllCastling & ~WhiteKingside;                     // h1
+    mask[56] = AllCastling & ~BlackQueenside;                   // a8
+    mask[60] = AllCastling & ~(BlackKingside | BlackQueenside); // e8
+    mask[63] = AllCastling & ~BlackKingside;                    // h8
+
+    return mask;
+}();
+
+// Irreversible state saved by makeMove and restored by unmakeMove, one entry per ply played
+struct StateInfo
+{
+    Piece capturedPiece;
+    int enPassantSquare = -1;
+    int castlingRights = 0;
+    int lastPawnOrCapture = 0;
+    uint64_t key = 0;
+    uint64_t pawnKey = 0;
+    uint64_t materialKey = 0;
+};
 
 class Board
 {
 public:
-    std::vector<Piece> pieces = loadFenString("3r4/3r4/3k4/8/8/3K4/3R4/3R4 w - - 0 1");
-    int selectedSquare = -1;
+    std::array<Piece, 64> pieces{};
     bool isWhiteTurn = true;
-    std::vector<Move> legalMoves;
-    bool isDragging = false;
 
     int checkmate = -1;
 
     int enPassantSquare = -1;
-    int lastPawnOrCapture = 0;
+    int castlingRights = 0;
+    int lastPawnOrCapture = 0; // Halfmove clock for the fifty-move rule
+    int fullmoveNumber = 1;
 
-    PieceList pieceList;
+    // Zobrist keys, updated incrementally by makeMove: the full position, pawns only, and piece counts only
+    uint64_t key = 0;
+    uint64_t pawnKey = 0;
+    uint64_t materialKey = 0;
 
-    bool isAnimating = false;
-    Move animMove;
-    float animT = 0.0f;
-    float animDuration = 0.15f;
+    std::vector<StateInfo> undoStack;
+
+    // Time budget for each computer move
+    long long moveTimeMs = 1000;
+
+    // Kept in sync with pieces by addPiece/removePiece/movePiece
+    Bitboard pieceBitboards[6] = {}; // Both colours, indexed by PieceType
+    Bitboard colourBitboards[2] = {};
+    Bitboard allPieces = 0;
 
     Board()
     {
-        findPieces();
+        undoStack.reserve(1024);
 
-        std::cout << "White pawns at squares: ";
-        for (int sq : pieceList.whitePawns)
-        {
-            std::cout << squareToChessNotation(sq) << "(" << sq << ") ";
-        }
-        std::cout << std::endl;
+        // Not loadFen, whose check test needs the move tables: a Board can be built before
+        // MoveGen::precomputeMoveData runs
+        setFen("3r4/3r4/3k4/8/8/3K4/3R4/3R4 w - - 0 1");
     }
 
-    void handleInput(Window &window, float boardSize)
+    void makeMove(Move move)
     {
-        if (window.wasMouseJustPressed())
+        const int from = move.from();
+        const int to = move.to();
+        const Piece movingPiece = pieces[from];
+        const bool movingIsWhite = movingPiece.isWhite;
+
+        // Save state for unmake
+        StateInfo &st = undoStack.emplace_back();
+        st.capturedPiece = pieces[to];
+        st.enPassantSquare = enPassantSquare;
+        st.castlingRights = castlingRights;
+        st.lastPawnOrCapture = lastPawnOrCapture;
+        st.key = key;
+        st.pawnKey = pawnKey;
+        st.materialKey = materialKey;
+
+        key ^= Zobrist::keys.blackToMove;
+
+        if (enPassantHashed())
+            key ^= Zobrist::keys.enPassant[getFile(enPassantSquare)];
+
+        if (move.isEnPassant() || st.capturedPiece.type != None)
         {
-            int square = window.screenToSquare(boardSize);
+            int capturedSquare = move.isEnPassant() ? (movingIsWhite ? (to - 8) : (to + 8)) : to;
+            st.capturedPiece = pieces[capturedSquare];
+            removePiece(capturedSquare);
 
-            if (square >= 0 && square < 64)
-            {
-                const Piece &piece = pieces[square];
-                if (piece.type != None && piece.isWhite == isWhiteTurn)
-                {
-                    selectedSquare = square;
-
-                    // Generate moves and extract destinations for this piece
-                    legalMoves.clear();
-                    auto all = MoveGen::generateLegalMoves(this);
-
-                    for (auto &m : all)
-                    {
-                        if (m.from == selectedSquare)
-                        {
-                            // For player input, only show Queen promotions
-                            // Filter out other promotion options
-                            if (m.wasPromotion && m.promotionPiece != Queen)
-                                continue;
-
-                            legalMoves.push_back(m);
-                        }
-                    }
-
-                    isDragging = !legalMoves.empty();
-                }
-            }
+            const Piece &captured = st.capturedPiece;
+            key ^= pieceKey(captured, capturedSquare);
+            materialKey ^= countKey(captured, Bitboards::popCount(piecesOf(captured.type, captured.isWhite)));
+            if (captured.type == Pawn)
+                pawnKey ^= pieceKey(captured, capturedSquare);
         }
-        else if (window.wasMouseJustReleased())
-        {
-            if (isDragging && selectedSquare != -1)
-            {
-                int targetSquare = window.screenToSquare(boardSize);
 
-                if (targetSquare >= 0 && targetSquare < 64)
-                {
-                    for (auto &move : legalMoves)
-                    {
-                        if (move.from == selectedSquare && move.to == targetSquare)
-                        {
-                            Move m = move;
-                            makeMove(m);
-                            break;
-                        }
-                    }
-                }
-            }
+        // Make the move on the board
+        movePiece(from, to);
 
-            selectedSquare = -1;
-            legalMoves.clear();
-            isDragging = false;
-        }
-    }
+        key ^= pieceKey(movingPiece, from) ^ pieceKey(movingPiece, to);
+        if (movingPiece.type == Pawn)
+            pawnKey ^= pieceKey(movingPiece, from) ^ pieceKey(movingPiece, to);
 
-    void makeMove(Move &move)
-    {
-        Piece &movingPiece = pieces[move.from];
-        Piece &targetPiece = pieces[move.to];
+        key ^= Zobrist::keys.castling[castlingRights];
+        castlingRights &= castlingRightsMask[from] & castlingRightsMask[to];
+        key ^= Zobrist::keys.castling[castlingRights];
 
-        // Save state for unmake
-        move.capturedPiece = pieces[move.to];
-        move.prevEnPassant = enPassantSquare;
-        move.movedPieceHadMoved = movingPiece.hasMoved;
+        if (movingPiece.type == Pawn || st.capturedPiece.type != None)
+            lastPawnOrCapture = 0;
+        else
+            lastPawnOrCapture++;
 
-        PieceType movingType = movingPiece.type;
-        bool movingIsWhite = movingPiece.isWhite;
+        if (!movingIsWhite)
+            fullmoveNumber++;
 
-        int movedSquares = abs(move.to - move.from);
-        bool isPawnDoubleMove = (movingPiece.type == Pawn && movedSquares == 16);
+        enPassantSquare = -1;
 
-        bool isEnPassant = (movingPiece.type == Pawn &&
-                            move.to == enPassantSquare &&
-                            enPassantSquare != -1);
+        if (movingPiece.type == Pawn && abs(to - from) == 16)
+        {
+            enPassantSquare = movingIsWhite ? (from + 8) : (from - 8);
+        }
 
-        // If capturing, remove captured piece from list
-        if (targetPiece.type != None)
+        // Handle Pawn Promotion
+        if (move.isPromotion())
         {
-            pieceList.removePiece(targetPiece.type, targetPiece.isWhite, move.to);
+            const Piece promoted(move.promotionPiece(), movingIsWhite);
+
+            removePiece(to);
+            addPiece(to, promoted);
+
+            key ^= pieceKey(movingPiece, to) ^ pieceKey(promoted, to);
+            pawnKey ^= pieceKey(movingPiece, to);
+            materialKey ^= countKey(movingPiece, Bitboards::popCount(piecesOf(Pawn, movingIsWhite))) ^
+                           countKey(promoted, Bitboards::popCount(piecesOf(promoted.type, movingIsWhite)) - 1);
         }
 
-        // Handle en passant capture
-        if (isEnPassant)
+        // Handle Castling
+        if (move.isCastling())
         {
-            int capturedPawnSquare = movingIsWhite ? (move.to - 8) : (move.to + 8);
-            move.epCapturedPiece = pieces[capturedPawnSquare];
-            move.epCapturedSquare = capturedPawnSquare;
-            move.wasEnPassant = true;
+            int backRank = movingIsWhite ? 0 : 56;
+            bool kingside = to == from + 2;
+            int rookFrom = backRank + (kingside ? 7 : 0);
+            int rookTo = backRank + (kingside ? 5 : 3);
 
-            pieces[capturedPawnSquare].type = None;
-            pieceList.removePiece(Pawn, !movingIsWhite, capturedPawnSquare);
+            movePiece(rookFrom, rookTo);
+            key ^= pieceKey(pieces[rookTo], rookFrom) ^ pieceKey(pieces[rookTo], rookTo);
         }
 
-        // Make the move on the board
-        targetPiece.type = movingPiece.type;
-        targetPiece.isWhite = movingPiece.isWhite;
-        targetPiece.hasMoved = true;
-        movingPiece.type = None;
+        isWhiteTurn = !isWhiteTurn;
 
-        enPassantSquare = -1;
+        if (enPassantHashed())
+            key ^= Zobrist::keys.enPassant[getFile(enPassantSquare)];
+
+#if defined(VERIFY_ZOBRIST)
+        verifyKeys("makeMove");
+#endif
+    }
+
+    void unmakeMove(Move move)
+    {
+        const int from = move.from();
+        const int to = move.to();
+        const StateInfo &st = undoStack.back();
+
+        isWhiteTurn = !isWhiteTurn;
 
-        if (isPawnDoubleMove)
+        // Undo castling
+        if (move.isCastling())
         {
-            enPassantSquare = movingIsWhite ? (move.from + 8) : (move.from - 8);
+            int backRank = isWhiteTurn ? 0 : 56;
+            bool kingside = to == from + 2;
+            int rookFrom = backRank + (kingside ? 7 : 0);
+            int rookTo = backRank + (kingside ? 5 : 3);
+
+            movePiece(rookTo, rookFrom);
         }
 
-        // Handle Pawn Promotion
-        int targetRank = getRank(move.to);
-        if (targetPiece.type == Pawn && (targetRank == 7 || targetRank == 0))
+        // Undo promotion: swap the promoted piece back for the pawn
+        if (move.isPromotion())
         {
-            // Use the promotionPiece from the move
-            promotePawn(move.to, move.promotionPiece);
-            move.wasPromotion = true;
+            removePiece(to);
+            addPiece(to, Piece(Pawn, isWhiteTurn));
+        }
 
-            // Update piece list: remove pawn, add promoted piece
-            pieceList.removePiece(Pawn, movingIsWhite, move.from);
-            pieceList.addPiece(move.promotionPiece, movingIsWhite, move.to);
+        // Move piece back
+        movePiece(to, from);
+
+        // Restore captured piece
+        if (move.isEnPassant())
+        {
+            addPiece(isWhiteTurn ? (to - 8) : (to + 8), st.capturedPiece);
         }
-        else
+        else if (st.capturedPiece.type != None)
         {
-            // Normal move - update piece position in list
-            pieceList.movePiece(movingType, movingIsWhite, move.from, move.to);
+            addPiece(to, st.capturedPiece);
         }
 
-        // Handle Castling
-        if (move.castling)
-        {
-            int backRank = movingIsWhite ? 0 : 56;
+        if (!isWhiteTurn)
+            fullmoveNumber--;
 
-            if (move.to == move.from + 2) // Kingside
-            {
-                Piece &rook = pieces[backRank + 7];
-                Piece &rookTarget = pieces[backRank + 5];
+        enPassantSquare = st.enPassantSquare;
+        castlingRights = st.castlingRights;
+        lastPawnOrCapture = st.lastPawnOrCapture;
+        key = st.key;
+        pawnKey = st.pawnKey;
+        materialKey = st.materialKey;
+        undoStack.pop_back();
 
-                move.rookHadMoved = rook.hasMoved;
+#if defined(VERIFY_ZOBRIST)
+        verifyKeys("unmakeMove");
+#endif
+    }
 
-                rookTarget.type = rook.type;
-                rookTarget.isWhite = rook.isWhite;
-                rookTarget.hasMoved = true;
-                rook.type = None;
+    // Passes the turn without moving, for null-move pruning. Never legal in a real game,
+    // so it must not be made while in check
+    void makeNullMove()
+    {
+        StateInfo &st = undoStack.emplace_back();
+        st.enPassantSquare = enPassantSquare;
+        st.castlingRights = castlingRights;
+        st.lastPawnOrCapture = lastPawnOrCapture;
+        st.key = key;
+        st.pawnKey = pawnKey;
+        st.materialKey = materialKey;
 
-                pieceList.movePiece(Rook, movingIsWhite, backRank + 7, backRank + 5);
-            }
-            else if (move.to == move.from - 2) // Queenside
-            {
-                Piece &rook = pieces[backRank];
-                Piece &rookTarget = pieces[backRank + 3];
+        if (enPassantHashed())
+            key ^= Zobrist::keys.enPassant[getFile(enPassantSquare)];
 
-                move.rookHadMoved = rook.hasMoved;
+        enPassantSquare = -1;
+        lastPawnOrCapture++;
 
-                rookTarget.type = rook.type;
-                rookTarget.isWhite = rook.isWhite;
-                rookTarget.hasMoved = true;
-                rook.type = None;
+        key ^= Zobrist::keys.blackToMove;
+        isWhiteTurn = !isWhiteTurn;
 
-                pieceList.movePiece(Rook, movingIsWhite, backRank, backRank + 3);
-            }
-        }
+#if defined(VERIFY_ZOBRIST)
+        verifyKeys("makeNullMove");
+#endif
+    }
+
+    void unmakeNullMove()
+    {
+        const StateInfo &st = undoStack.back();
 
         isWhiteTurn = !isWhiteTurn;
+        enPassantSquare = st.enPassantSquare;
+        lastPawnOrCapture = st.lastPawnOrCapture;
+        key = st.key;
+        undoStack.pop_back();
+
+#if defined(VERIFY_ZOBRIST)
+        verifyKeys("unmakeNullMove");
+#endif
+    }
+
+    static uint64_t pieceKey(const Piece &piece, int square)
+    {
+        return Zobrist::keys.pieces[piece.isWhite ? White : Black][piece.type][square];
     }
 
-    void unmakeMove(Move &move)
+    // The material key XORs in one key per piece of each kind, so changing a count from
+    // n to n + 1 (or back) toggles the key for index n
+    static uint64_t countKey(const Piece &piece, int index)
     {
-        Piece &from = pieces[move.from];
-        Piece &to = pieces[move.to];
+        return Zobrist::keys.pieces[piece.isWhite ? White : Black][piece.type][index];
+    }
 
-        PieceType movedType = to.type;
-        bool movedIsWhite = to.isWhite;
+    // The en passant file only goes into the key if a pawn of the side to move could
+    // actually capture, otherwise identical positions would hash differently
+    bool enPassantHashed() const
+    {
+        if (enPassantSquare == -1)
+            return false;
 
-        // Restore en passant square
-        enPassantSquare = move.prevEnPassant;
+        const Bitboard ep = Bitboards::squareBB(enPassantSquare);
+        const Bitboard attackers = isWhiteTurn ? Bitboards::shiftSouthEast(ep) | Bitboards::shiftSouthWest(ep)
+                                               : Bitboards::shiftNorthEast(ep) | Bitboards::shiftNorthWest(ep);
 
-        // Undo castling
-        if (move.castling)
+        return attackers & piecesOf(Pawn, isWhiteTurn);
+    }
+
+    uint64_t computeKey() const
+    {
+        uint64_t k = 0;
+
+        for (int square = 0; square < 64; square++)
         {
-            int backRank = movedIsWhite ? 0 : 56;
+            if (pieces[square].type != None)
+                k ^= pieceKey(pieces[square], square);
+        }
 
-            if (move.to == move.from + 2) // Kingside
-            {
-                pieces[backRank + 7] = pieces[backRank + 5];
-                pieces[backRank + 7].hasMoved = move.rookHadMoved;
-                pieces[backRank + 5].type = None;
+        k ^= Zobrist::keys.castling[castlingRights];
 
-                pieceList.movePiece(Rook, movedIsWhite, backRank + 5, backRank + 7);
-            }
-            else if (move.to == move.from - 2) // Queenside
-            {
-                pieces[backRank] = pieces[backRank + 3];
-                pieces[backRank].hasMoved = move.rookHadMoved;
-                pieces[backRank + 3].type = None;
+        if (enPassantHashed())
+            k ^= Zobrist::keys.enPassant[getFile(enPassantSquare)];
 
-                pieceList.movePiece(Rook, movedIsWhite, backRank + 3, backRank);
-            }
-        }
+        if (!isWhiteTurn)
+            k ^= Zobrist::keys.blackToMove;
+
+        return k;
+    }
+
+    uint64_t computePawnKey() const
+    {
+        uint64_t k = 0;
 
-        // Undo promotion
-        if (move.wasPromotion)
+        for (int square = 0; square < 64; square++)
         {
-            // Remove the promoted piece, restore the pawn
-            pieceList.removePiece(move.promotionPiece, movedIsWhite, move.to);
-            pieceList.addPiece(Pawn, movedIsWhite, move.from);
-            movedType = Pawn;
+            if (pieces[square].type == Pawn)
+                k ^= pieceKey(pieces[square], square);
         }
-        else
+
+        return k;
+    }
+
+    uint64_t computeMaterialKey() const
+    {
+        uint64_t k = 0;
+
+        for (bool isWhite : {true, false})
         {
-            // Normal unmove - update piece position in list
-            pieceList.movePiece(movedType, movedIsWhite, move.to, move.from);
+            for (PieceType type : {Pawn, Knight, Bishop, Rook, Queen, King})
+            {
+                for (int n = 0; n < Bitboards::popCount(piecesOf(type, isWhite)); n++)
+                    k ^= countKey(Piece(type, isWhite), n);
+            }
         }
 
-        // Move piece back
-        from = to;
-        from.hasMoved = move.movedPieceHadMoved;
+        return k;
+    }
 
-        if (move.wasPromotion)
+    // Recompute every key from scratch and stop if the incremental ones have drifted
+    void verifyKeys(const char *where) const
+    {
+        if (key != computeKey() || pawnKey != computePawnKey() || materialKey != computeMaterialKey())
         {
-            from.type = Pawn;
+            std::cerr << "Zobrist key mismatch after " << where << " in " << getFen() << std::endl;
+            std::abort();
         }
+    }
 
-        // Restore captured piece
-        if (move.wasEnPassant)
-        {
-            pieces[move.epCapturedSquare] = move.epCapturedPiece;
-            to.type = None;
+    void addPiece(int square, const Piece &piece)
+    {
+        const Bitboard b = Bitboards::squareBB(square);
 
-            pieceList.addPiece(Pawn, !movedIsWhite, move.epCapturedSquare);
-        }
-        else
-        {
-            to = move.capturedPiece;
+        pieces[square] = piece;
+        pieceBitboards[piece.type] |= b;
+        colourBitboards[piece.isWhite ? White : Black] |= b;
+        allPieces |= b;
+    }
 
-            // If we captured a piece, restore it to piece list
-            if (move.capturedPiece.type != None)
-            {
-                pieceList.addPiece(move.capturedPiece.type, move.capturedPiece.isWhite, move.to);
-            }
-        }
+    void removePiece(int square)
+    {
+        const Piece &piece = pieces[square];
+        const Bitboard b = Bitboards::squareBB(square);
 
-        isWhiteTurn = !isWhiteTurn;
+        pieceBitboards[piece.type] ^= b;
+        colourBitboards[piece.isWhite ? White : Black] ^= b;
+        allPieces ^= b;
+        pieces[square] = Piece();
+    }
+
+    // Target square must be empty
+    void movePiece(int from, int to)
+    {
+        const Piece &piece = pieces[from];
+        const Bitboard fromTo = Bitboards::squareBB(from) | Bitboards::squareBB(to);
+
+        pieceBitboards[piece.type] ^= fromTo;
+        colourBitboards[piece.isWhite ? White : Black] ^= fromTo;
+        allPieces ^= fromTo;
+        pieces[to] = piece;
+        pieces[from] = Piece();
     }
 
+    // Rebuild the bitboards from the pieces array, e.g. after loading a FEN string
     void findPieces()
     {
-        pieceList.clear();
+        for (Bitboard &b : pieceBitboards)
+            b = 0;
+        colourBitboards[White] = colourBitboards[Black] = 0;
+        allPieces = 0;
+
         for (int i = 0; i < 64; i++)
         {
-            Piece &piece = pieces[i];
+            Piece piece = pieces[i];
             if (piece.type != None)
             {
-                pieceList.addPiece(piece.type, piece.isWhite, i);
+                addPiece(i, piece);
             }
         }
     }
 
-    void updateAnimation(float dt)
+    // Exactly 8 ranks of 8 files, only piece letters and digits, one king per side
+    static bool isValidPlacement(const std::string &placement)
     {
-        if (!isAnimating)
-            return;
+        int rank = 0, file = 0;
+        int kings[2] = {0, 0};
 
-        animT += dt;
-        if (animT >= animDuration)
+        for (char c : placement)
         {
-            animT = animDuration;
-            makeMove(animMove);
-            isAnimating = false;
+            if (c == '/')
+            {
+                if (file != 8 || ++rank > 7)
+                    return false;
+
+                file = 0;
+            }
+            else if (c >= '1' && c <= '8')
+            {
+                file += c - '0';
+            }
+            else if (std::string("pnbrqkPNBRQK").find(c) != std::string::npos)
+            {
+                if (c == 'K' || c == 'k')
+                    kings[c == 'K' ? White : Black]++;
+
+                file++;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (file > 8)
+                return false;
         }
+
+        return rank == 7 && file == 8 && kings[White] == 1 && kings[Black] == 1;
     }
 
-    glm::ivec2 squareToWorldPos(int i)
+    // Load all six FEN fields. The move clocks may be left off. Returns false, leaving the board
+    // untouched, on a malformed placement or side to move, or when the side that just moved is in check
+    bool loadFen(const std::string &fen)
     {
-        int posX = i % 8 + 1;
-        int posY = floor((i + 8.0f) / 8.0f);
+        const Board previous = *this;
 
-        return glm::ivec2(posX, posY);
-    }
+        if (!setFen(fen))
+            return false;
 
-    void drawPieces(Renderer& renderer, Window &window);
+        // Otherwise the search would find a move that captures a king
+        if (MoveGen::isSquareAttacked(this, kingSquare(!isWhiteTurn), isWhiteTurn))
+        {
+            *this = previous;
+            return false;
+        }
 
-    void moveComputer(bool isWhite)
+        return true;
+    }
+
+    // loadFen without the check test. Returns false, leaving the board untouched, on a malformed
+    // placement or side to move
+    bool setFen(const std::string &fen)
     {
-        if (checkmate >= 0)
-            return;
+        std::istringstream stream(fen);
+        std::string placement, side, castling = "-", enPassant = "-";
+        int halfmove = 0, fullmove = 1;
 
-        if (isWhiteTurn == isWhite)
-        {
-            Move move = chooseComputerMove(isWhite);
+        if (!(stream >> placement >> side))
+            return false;
+
+        stream >> castling >> enPassant >> halfmove >> fullmove;
+
+        if ((side != "w" && side != "b") || !isValidPlacement(placement))
+            return false;
+
+        pieces = loadFenString(placement.c_str());
+        findPieces();
+        undoStack.clear();
 
-            if (move.from < 0 || move.to < 0)
-                return; // game over
+        isWhiteTurn = side == "w";
 
-            animMove = move;
-            animT = 0.0f;
+        castlingRights = 0;
+        for (char c : castling)
+        {
+            switch (c)
+            {
+            case 'K':
+                castlingRights |= WhiteKingside;
+                break;
+            case 'Q':
+                castlingRights |= WhiteQueenside;
+                break;
+            case 'k':
+                castlingRights |= BlackKingside;
+                break;
+            case 'q':
+                castlingRights |= BlackQueenside;
+                break;
+            }
         }
-    }
 
-    Move chooseComputerMove(bool isWhite)
-    {
-        auto moves = MoveGen::generateLegalMoves(this);
+        // A right is only kept while its king and rook are on their home squares,
+        // so castling never moves a piece that isn't there
+        auto isOn = [this](int square, PieceType type, bool isWhite)
+        {
+            return pieces[square].type == type && pieces[square].isWhite == isWhite;
+        };
+
+        if (!isOn(4, King, true))
+            castlingRights &= ~(WhiteKingside | WhiteQueenside);
+        if (!isOn(60, King, false))
+            castlingRights &= ~(BlackKingside | BlackQueenside);
+        if (!isOn(7, Rook, true))
+            castlingRights &= ~WhiteKingside;
+        if (!isOn(0, Rook, true))
+            castlingRights &= ~WhiteQueenside;
+        if (!isOn(63, Rook, false))
+            castlingRights &= ~BlackKingside;
+        if (!isOn(56, Rook, false))
+            castlingRights &= ~BlackQueenside;
 
-        if (moves.empty())
+        // Likewise the en passant square is only kept if a pawn can have just double pushed past it
+        enPassantSquare = chessNotationToSquare(enPassant);
+
+        if (enPassantSquare != -1)
         {
-            checkmate = isWhite ? 1 : 0;
-            return Move(-1, -1);
+            const int up = isWhiteTurn ? 8 : -8;
+
+            if (getRank(enPassantSquare) != (isWhiteTurn ? 5 : 2) || pieces[enPassantSquare].type != None ||
+                pieces[enPassantSquare + up].type != None || !isOn(enPassantSquare - up, Pawn, !isWhiteTurn))
+                enPassantSquare = -1;
         }
 
-        Move bestMove;
+        lastPawnOrCapture = halfmove;
+        fullmoveNumber = fullmove;
+        checkmate = -1;
 
-        const int infinity = 200000;
+        key = computeKey();
+        pawnKey = computePawnKey();
+        materialKey = computeMaterialKey();
 
-        int bestValue = -infinity;
-        int alpha = -infinity;
-        int beta = infinity;
-        int searchDepth = 6;
+        return true;
+    }
 
-        orderMoves(moves);
+    std::string getFen() const
+    {
+        std::string fen;
 
-        for (auto &move : moves)
+        for (int rank = 7; rank >= 0; rank--)
         {
-            makeMove(move);
-            int val = -search(searchDepth-1, -beta, -alpha, 1);
-            unmakeMove(move);
+            int empty = 0;
 
-            if (val > bestValue)
+            for (int file = 0; file < 8; file++)
             {
-                bestValue = val;
-                bestMove = move;
+                const Piece &piece = pieces[rank * 8 + file];
+
+                if (piece.type == None)
+                {
+                    empty++;
+                    continue;
+                }
+
+                if (empty > 0)
+                    fen += char('0' + empty);
+                empty = 0;
+
+                const char c = "pnbrqk"[piece.type];
+                fen += piece.isWhite ? char(toupper(c)) : c;
             }
 
-            alpha = std::max(alpha, val);
+            if (empty > 0)
+                fen += char('0' + empty);
+
+            if (rank > 0)
+                fen += '/';
         }
 
-        std::cout << "Best move evaluation: " << bestValue << std::endl;
+        fen += isWhiteTurn ? " w " : " b ";
+
+        if (castlingRights & WhiteKingside)
+            fen += 'K';
+        if (castlingRights & WhiteQueenside)
+            fen += 'Q';
+        if (castlingRights & BlackKingside)
+            fen += 'k';
+        if (castlingRights & BlackQueenside)
+            fen += 'q';
+        if (!castlingRights)
+            fen += '-';
 
-        isAnimating = true;
+        fen += ' ';
+        fen += enPassantSquare == -1 ? "-" : squareToChessNotation(enPassantSquare);
+        fen += " " + std::to_string(lastPawnOrCapture) + " " + std::to_string(fullmoveNumber);
 
-        return bestMove;
+        return fen;
     }
 
-    std::string squareToChessNotation(int square)
+    Bitboard piecesOf(PieceType type, bool isWhite) const
+    {
+        return pieceBitboards[type] & colourBitboards[isWhite ? White : Black];
+    }
+
+    int kingSquare(bool isWhite) const
+    {
+        Bitboard king = piecesOf(King, isWhite);
+        return king ? Bitboards::lsb(king) : -1;
+    }
+
+    bool inCheck() const
+    {
+        return MoveGen::isSquareAttacked(this, kingSquare(isWhiteTurn), !isWhiteTurn);
+    }
+
+    // Knights, bishops, rooks and queens
+    Bitboard nonPawnPieces(bool isWhite) const
+    {
+        return colourBitboards[isWhite ? White : Black] & ~(pieceBitboards[Pawn] | pieceBitboards[King]);
+    }
+
+    std::string squareToChessNotation(int square) const
     {
         int file = getFile(square);
         int rank = getRank(square) + 1;
@@ -604,179 +688,66 @@ public:
         return notation;
     }
 
-    int moveGenerationTest(int depth)
+    // Inverse of squareToChessNotation, -1 for anything that isn't a square
+    static int chessNotationToSquare(const std::string &notation)
     {
-        if(depth == 0)
-            return 1;
+        if (notation.size() != 2 || notation[0] < 'a' || notation[0] > 'h' || notation[1] < '1' || notation[1] > '8')
+            return -1;
 
-        auto moves = MoveGen::generateLegalMoves(this);
-        int numPositions = 0;
-
-        for(auto &move : moves)
-        {
-            makeMove(move);
-            numPositions += moveGenerationTest(depth - 1);
-            unmakeMove(move);
-        }
-
-        return numPositions;
-    }
-
-    void perftDivide(int depth)
-    {
-        auto moves = MoveGen::generateLegalMoves(this);
-        int total = 0;
-
-        for (auto &move : moves)
-        {
-            makeMove(move);
-            int nodes = moveGenerationTest(depth - 1);
-            unmakeMove(move);
-
-            std::cout
-                << squareToChessNotation(move.from)
-                << squareToChessNotation(move.to)
-                << ": "
-                << nodes
-                << std::endl;
-
-            total += nodes;
-        }
-
-        std::cout << "Total: " << total << std::endl;
+        return (notation[1] - '1') * 8 + (notation[0] - 'a');
     }
 
-    void orderMoves(std::vector<Move> &moves)
+    // Long algebraic notation as used by UCI, e.g. e2e4, e7e8q
+    std::string moveToUci(Move move) const
     {
-        auto scoreMove = [this](const Move &move) -> int
-        {
-            int score = 0;
+        if (move == Move::none())
+            return "0000";
 
-            PieceType moveType = pieces[move.from].type;
-            PieceType captureType = pieces[move.to].type;
+        std::string uci = squareToChessNotation(move.from()) + squareToChessNotation(move.to());
 
-            if (move.wasEnPassant)
-            {
-                score = 10 * PieceData::PawnValue - PieceData::PawnValue;
-            }
-            else if (captureType != None)
-            {
-                score = 10 * getPieceValue(captureType) - getPieceValue(moveType);
-            }
+        if (move.isPromotion())
+            uci += "nbrq"[move.promotionPiece() - Knight];
 
-            if (move.wasPromotion)
-            {
-                score += getPieceValue(move.promotionPiece);
-            }
-
-            return score;
-        };
-
-        std::sort(moves.begin(), moves.end(), [&](const Move &a, const Move &b)
-                  { return scoreMove(a) > scoreMove(b); });
+        return uci;
     }
 
-    int searchAllCaptures(int alpha, int beta)
+    // The legal move written as uci in this position, or none if there isn't one
+    Move parseUciMove(const std::string &uci) const
     {
-        int eval = evaluate();
-
-        if(eval >= beta)
-            return beta;
-        
-        alpha = std::max(alpha, eval);
-
-        std::vector<Move> captureMoves = MoveGen::generateLegalMoves(this, true);
-        orderMoves(captureMoves);
+        MoveList moves;
+        MoveGen::generateLegalMoves(this, moves);
 
-        for(auto &move : captureMoves)
+        for (const Move &move : moves)
         {
-            makeMove(move);
-            eval = -searchAllCaptures(-beta, -alpha);
-            unmakeMove(move);
-
-            if (eval >= beta)
-                return beta;
-
-            alpha = std::max(alpha, eval);
+            if (moveToUci(move) == uci)
+                return move;
         }
 
-        return alpha;
+        return Move::none();
     }
 
-    int search(int depth, int alpha, int beta, int ply)
+    int evaluate()
     {
-        if (depth == 0)
-            return searchAllCaptures(alpha, beta);
-
-        auto moves = MoveGen::generateLegalMoves(this);
-
-        if (moves.empty())
-        {
-            int ourKing = isWhiteTurn ? pieceList.whiteKing : pieceList.blackKing;
-            bool inCheck = MoveGen::isSquareAttacked(this, ourKing, !isWhiteTurn);
-
-            // Checkmate detected
-            if (inCheck)
-            {
-                return -100000 + ply;
-            }
-            // Stalemate
-            return 0;
-        }
-
-        orderMoves(moves);
+        int eval = 0;
 
-        for (auto &move : moves)
-        {
-            makeMove(move);
-            int eval = -search(depth - 1, -beta, -alpha, ply + 1);
-            unmakeMove(move);
+        eval += countMaterial(true) - countMaterial(false);
 
-            if (eval >= beta)
-            {
-                return beta;
-            }
-            alpha = std::max(alpha, eval);
-        }
+        // Piece-square tables (flipped for black)
+        Bitboard bb = piecesOf(Pawn, true);
+        while (bb)
+            eval += PieceData::pawnTable[Bitboards::popLsb(bb)];
 
-        return alpha;
-    }
+        bb = piecesOf(Knight, true);
+        while (bb)
+            eval += PieceData::knightTable[Bitboards::popLsb(bb)];
 
-    int evaluate()
-    {
-        int eval = 0;
+        bb = piecesOf(Pawn, false);
+        while (bb)
+            eval -= PieceData::pawnTable[63 - Bitboards::popLsb(bb)];
 
-        // White pawns
-        for (int sq : pieceList.whitePawns)
-            eval += PieceData::PawnValue + PieceData::pawnTable[sq];
-
-        // White knights
-        for (int sq : pieceList.whiteKnights)
-            eval += PieceData::KnightValue + PieceData::knightTable[sq];
-
-        // (Add similar for other white pieces with material only)
-        for (int sq : pieceList.whiteBishops)
-            eval += PieceData::BishopValue;
-        for (int sq : pieceList.whiteRooks)
-            eval += PieceData::RookValue;
-        for (int sq : pieceList.whiteQueens)
-            eval += PieceData::QueenValue;
-
-        // Black pawns (flip table)
-        for (int sq : pieceList.blackPawns)
-            eval -= PieceData::PawnValue + PieceData::pawnTable[63 - sq];
-
-        // Black knights (flip table)
-        for (int sq : pieceList.blackKnights)
-            eval -= PieceData::KnightValue + PieceData::knightTable[63 - sq];
-
-        // (Add similar for other black pieces)
-        for (int sq : pieceList.blackBishops)
-            eval -= PieceData::BishopValue;
-        for (int sq : pieceList.blackRooks)
-            eval -= PieceData::RookValue;
-        for (int sq : pieceList.blackQueens)
-            eval -= PieceData::QueenValue;
+        bb = piecesOf(Knight, false);
+        while (bb)
+            eval -= PieceData::knightTable[63 - Bitboards::popLsb(bb)];
 
         // --- ENDGAME EVALUATION ---
 
@@ -807,8 +778,8 @@ public:
 
     int endgameEval(bool isWhite, float endgameWeight)
     {
-        int ourKing = isWhite ? pieceList.whiteKing : pieceList.blackKing;
-        int opponentKing = isWhite ? pieceList.blackKing : pieceList.whiteKing;
+        int ourKing = kingSquare(isWhite);
+        int opponentKing = kingSquare(!isWhite);
 
         int eval = 0;
 
@@ -836,23 +807,12 @@ public:
     {
         int material = 0;
 
-        if(isWhite)
-        {
-            if(withPawns)
-                material += pieceList.whitePawns.size() * PieceData::PawnValue;
-            material += pieceList.whiteKnights.size() * PieceData::KnightValue;
-            material += pieceList.whiteBishops.size() * PieceData::BishopValue;
-            material += pieceList.whiteRooks.size() * PieceData::RookValue;
-            material += pieceList.whiteQueens.size() * PieceData::QueenValue;
-        } else
-        {
-            if(withPawns)
-                material += pieceList.blackPawns.size() * PieceData::PawnValue;
-            material += pieceList.blackKnights.size() * PieceData::KnightValue;
-            material += pieceList.blackBishops.size() * PieceData::BishopValue;
-            material += pieceList.blackRooks.size() * PieceData::RookValue;
-            material += pieceList.blackQueens.size() * PieceData::QueenValue;
-        }
+        if(withPawns)
+            material += Bitboards::popCount(piecesOf(Pawn, isWhite)) * PieceData::PawnValue;
+        material += Bitboards::popCount(piecesOf(Knight, isWhite)) * PieceData::KnightValue;
+        material += Bitboards::popCount(piecesOf(Bishop, isWhite)) * PieceData::BishopValue;
+        material += Bitboards::popCount(piecesOf(Rook, isWhite)) * PieceData::RookValue;
+        material += Bitboards::popCount(piecesOf(Queen, isWhite)) * PieceData::QueenValue;
 
         return material;
     }
@@ -899,25 +859,6 @@ public:
         return square >= 0 && square <= 63 && pieces[square].type != None;
     }
 
-    int getFile(int square) { return square % 8; }
-    int getRank(int square) { return square / 8; }
-
-    void promotePawn(int square, PieceType type)
-    {
-        Piece &piece = pieces[square];
-
-        if (square < 56 && piece.isWhite == true)
-            return;
-
-        if (square > 7 && piece.isWhite == false)
-            return;
-
-        if (piece.type != Pawn)
-            return;
-
-        if (type != Pawn && type != King && type != None)
-        {
-            piece.type = type;
-        }
-    }
+    int getFile(int square) const { return square % 8; }
+    int getRank(int square) const { return square / 8; }
 };
\ No newline at end of file
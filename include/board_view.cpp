@@ -0,0 +1,98 @@
+#include "board_view.h"
+#include "engine.h"
+#include "renderer.h"
+#include "window.h"
+
+inline float ease(float t)
+{
+    return 0.5f - cos(t * 3.14159265f) * 0.5f;
+}
+
+void BoardView::drawPieces(Renderer &renderer, Window &window)
+{
+    for (int i = 0; i < 64; i++)
+    {
+        const Piece &piece = board.pieces[i];
+        if (piece.type == None)
+            continue;
+
+        if (i == selectedSquare && isDragging)
+            continue;
+
+        glm::vec2 pos = squareToWorldPos(i);
+
+        if (isAnimating && i == animMove.from())
+        {
+            glm::vec2 from = squareToWorldPos(animMove.from());
+            glm::vec2 to = squareToWorldPos(animMove.to());
+            float t = ease(animT/animDuration);
+            pos = glm::mix(from, to, t);
+        }
+
+        renderer.drawPiece(this, window, piece, pos, i);
+    }
+
+    if(selectedSquare >= 0 && selectedSquare <= 63 && isDragging)
+        renderer.drawPiece(this, window, board.pieces[selectedSquare], glm::vec2(0.0f), selectedSquare);
+}
+
+void BoardView::updateAnimation(float dt, Engine &engine)
+{
+    EngineEvent event;
+
+    while (engine.poll(event))
+    {
+        const SearchInfo &info = event.info;
+
+        if (event.type == EngineEventType::Progress)
+        {
+            std::cout << "Depth " << info.depth << ": " << board.squareToChessNotation(info.bestMove.from())
+                      << board.squareToChessNotation(info.bestMove.to()) << " eval " << info.score
+                      << " nodes " << info.nodes << " time " << info.timeMs << "ms" << std::endl;
+            continue;
+        }
+
+        waitingForEngine = false;
+
+        if (info.bestMove == Move::none())
+            continue; // game over
+
+        std::cout << "Best move evaluation: " << info.score << std::endl;
+
+        animMove = info.bestMove;
+        animT = 0.0f;
+        isAnimating = true;
+    }
+
+    if (!isAnimating)
+        return;
+
+    animT += dt;
+    if (animT >= animDuration)
+    {
+        animT = animDuration;
+        board.makeMove(animMove);
+        isAnimating = false;
+    }
+}
+
+void BoardView::moveComputer(bool isWhite, Engine &engine)
+{
+    if (board.checkmate >= 0 || waitingForEngine || board.isWhiteTurn != isWhite)
+        return;
+
+    MoveList moves;
+    MoveGen::generateLegalMoves(&board, moves);
+
+    if (moves.empty())
+    {
+        board.checkmate = isWhite ? 1 : 0;
+        return;
+    }
+
+    SearchLimits limits;
+    limits.moveTimeMs = board.moveTimeMs;
+
+    engine.requestSearch(board, limits);
+    waitingForEngine = true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+
+#include "window.h"
+#include "board.h"
+#include "move_generator.h"
+
+class Renderer;
+class Engine;
+
+// Everything the GUI adds on top of a Board: mouse input, piece dragging, move animation
+// and handing moves off to the engine. Board itself stays free of GLFW/OpenGL
+class BoardView
+{
+public:
+    Board &board;
+
+    int selectedSquare = -1;
+    std::vector<Move> legalMoves;
+    bool isDragging = false;
+
+    // Set while the engine thread is searching a move for us
+    bool waitingForEngine = false;
+
+    bool isAnimating = false;
+    Move animMove;
+    float animT = 0.0f;
+    float animDuration = 0.15f;
+
+    explicit BoardView(Board &board) : board(board) {}
+
+    void handleInput(Window &window, float boardSize)
+    {
+        if (window.wasMouseJustPressed())
+        {
+            int square = window.screenToSquare(boardSize);
+
+            if (square >= 0 && square < 64)
+            {
+                const Piece &piece = board.pieces[square];
+                if (piece.type != None && piece.isWhite == board.isWhiteTurn)
+                {
+                    selectedSquare = square;
+
+                    // Generate moves and extract destinations for this piece
+                    legalMoves.clear();
+                    MoveList all;
+                    MoveGen::generateLegalMoves(&board, all);
+
+                    for (auto &m : all)
+                    {
+                        if (m.from() == selectedSquare)
+                        {
+                            // For player input, only show Queen promotions
+                            // Filter out other promotion options
+                            if (m.isPromotion() && m.promotionPiece() != Queen)
+                                continue;
+
+                            legalMoves.push_back(m);
+                        }
+                    }
+
+                    isDragging = !legalMoves.empty();
+                }
+            }
+        }
+        else if (window.wasMouseJustReleased())
+        {
+            if (isDragging && selectedSquare != -1)
+            {
+                int targetSquare = window.screenToSquare(boardSize);
+
+                if (targetSquare >= 0 && targetSquare < 64)
+                {
+                    for (auto &move : legalMoves)
+                    {
+                        if (move.from() == selectedSquare && move.to() == targetSquare)
+                        {
+                            board.makeMove(move);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            selectedSquare = -1;
+            legalMoves.clear();
+            isDragging = false;
+        }
+    }
+
+    // Also picks up the engine's move once it arrives, and starts animating it
+    void updateAnimation(float dt, Engine &engine);
+
+    glm::ivec2 squareToWorldPos(int i)
+    {
+        int posX = i % 8 + 1;
+        int posY = floor((i + 8.0f) / 8.0f);
+
+        return glm::ivec2(posX, posY);
+    }
+
+    void drawPieces(Renderer& renderer, Window &window);
+
+    // Asks the engine for a move if it's the computer's turn. Returns straight away,
+    // the move is played by updateAnimation when the search finishes
+    void moveComputer(bool isWhite, Engine &engine);
+};
@@ -1,137 +1,146 @@
 #pragma once
 
 #include "board.h"
+#include "search.h"
+#include "transposition_table.h"
+#include <algorithm>
 #include <chrono>
-#include <vector>
-#include <string>
-#include <fstream>
+#include <cmath>
 #include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
 
 struct TestPosition
 {
     std::string name;
     std::string fen;
-    bool isWhiteTurn;
 };
 
+// One position searched to one depth, over every run
 struct TestResult
 {
     std::string positionName;
     int depth;
-    int bestMoveFrom;
-    int bestMoveTo;
-    int evaluation;
-    double timeMs;
-};
-
-struct BestMoveResult
-{
-    Move move;
+    std::string bestMove;
     int evaluation;
+    uint64_t nodes; // Nodes to reach this depth, the same every run with one thread and a cleared TT
+    double medianMs; // Time to reach this depth
+    double minMs;
+    double maxMs;
+    double stddevMs;
 };
 
+// Search regression benchmark. Each run is one iterative deepening search per position from a
+// cleared table, and records the time and node count at which every depth completed. Repeating
+// the runs gives a median that a later build can be compared against
 class ChessTester
 {
 public:
     std::vector<TestPosition> testPositions = {
-        {"Starting Position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR", true},
-        {"Mid Game", "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R", true},
-        {"Endgame - Rook vs Pawns", "8/5pk1/6p1/8/8/6P1/5PKR/8", true},
-        {"Tactical - Fork Available", "rnbqkb1r/pppp1ppp/5n2/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R", true},
-        {"Scholar's Mate Position", "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR", true},
-        {"Open Position", "rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N2N2/PP2PPPP/R1BQKB1R", true},
+        {"Starting Position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+        {"Mid Game", "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4"},
+        {"Endgame - Rook vs Pawns", "8/5pk1/6p1/8/8/6P1/5PKR/8 w - - 0 1"},
+        {"Tactical - Fork Available", "rnbqkb1r/pppp1ppp/5n2/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3"},
+        {"Scholar's Mate Position", "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4"},
+        {"Open Position", "rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N2N2/PP2PPPP/R1BQKB1R w KQkq - 2 4"},
+        {"Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
     };
 
     std::vector<TestResult> testResults;
 
-    void runSingleTest(const TestPosition &pos, int depth)
+    // Searches pos to depth runs times and adds one result per completed depth
+    void runSingleTest(const TestPosition &pos, int depth, int runs)
     {
         Board board;
-        board.pieces = loadFenString(pos.fen.c_str());
-        board.isWhiteTurn = pos.isWhiteTurn;
-        board.findKings();
-
-        auto start = std::chrono::high_resolution_clock::now();
+        board.loadFen(pos.fen);
 
-        BestMoveResult result = findBestMove(board, depth, pos.isWhiteTurn);
+        // timesMs[d - 1][run], filled in as each iteration completes
+        std::vector<std::vector<double>> timesMs(depth);
+        std::vector<SearchInfo> infos(depth);
 
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        double timeMs = duration.count() / 1000.0;
+        std::chrono::steady_clock::time_point start;
 
-        TestResult testResult;
-        testResult.positionName = pos.name;
-        testResult.depth = depth;
-        testResult.bestMoveFrom = result.move.from;
-        testResult.bestMoveTo = result.move.to;
-        testResult.evaluation = result.evaluation;
-        testResult.timeMs = timeMs;
-
-        testResults.push_back(testResult);
-    }
+        Searcher.onIteration = [&](const SearchInfo &info)
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            timesMs[info.depth - 1].push_back(std::chrono::duration<double, std::milli>(elapsed).count());
+            infos[info.depth - 1] = info;
+        };
 
-    void runAllTests(int maxDepth)
-    {
-        testResults.clear();
+        SearchLimits limits;
+        limits.depth = depth;
 
-        for (const TestPosition &pos : testPositions)
+        for (int run = 0; run < std::max(runs, 1); run++)
         {
-            for (int depth = 1; depth <= maxDepth; depth++)
-            {
-                runSingleTest(pos, depth);
-            }
+            TT.clear();
+
+            start = std::chrono::steady_clock::now();
+            Searcher.go(board, limits);
         }
-    }
 
-    BestMoveResult findBestMove(Board &board, int depth, bool isWhite)
-    {
-        std::vector<Move> allMoves;
+        Searcher.onIteration = nullptr;
 
-        for (int i = 0; i < 64; i++)
+        for (int d = 1; d <= depth; d++)
         {
-            Piece &piece = board.pieces[i];
-            if (piece.type == None || piece.isWhite != isWhite)
+            std::vector<double> &times = timesMs[d - 1];
+
+            // A mate found early ends the search before the last depths
+            if (times.empty())
                 continue;
 
-            std::vector<int> moves = board.generateLegalMoves(i);
-            for (int to : moves)
-            {
-                Move m;
-                m.from = i;
-                m.to = to;
-                allMoves.push_back(m);
-            }
-        }
+            std::sort(times.begin(), times.end());
 
-        BestMoveResult result;
+            const size_t n = times.size();
+            const double median = n % 2 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
 
-        if (allMoves.empty())
-        {
-            result.move.from = -1;
-            result.move.to = -1;
-            result.evaluation = 0;
-            return result;
+            double mean = 0.0;
+            for (double t : times)
+                mean += t;
+            mean /= n;
+
+            double variance = 0.0;
+            for (double t : times)
+                variance += (t - mean) * (t - mean);
+
+            TestResult result;
+            result.positionName = pos.name;
+            result.depth = d;
+            result.bestMove = board.moveToUci(infos[d - 1].bestMove);
+            result.evaluation = infos[d - 1].score;
+            result.nodes = infos[d - 1].nodes;
+            result.medianMs = median;
+            result.minMs = times.front();
+            result.maxMs = times.back();
+            result.stddevMs = std::sqrt(variance / n);
+
+            testResults.push_back(result);
         }
+    }
 
-        int bestScore = isWhite ? -999999 : 999999;
-        Move bestMove = allMoves[0];
+    // Single threaded with a cleared default-size table, so node counts are reproducible.
+    // The search's thread count, table size and progress callback are restored afterwards
+    void runAllTests(int maxDepth, int runs)
+    {
+        const int threads = Searcher.threadCount();
+        const size_t hashMB = TT.sizeMB();
+        auto onIteration = Searcher.onIteration;
+        Searcher.setThreads(1);
+        TT.resize(TranspositionTable::DefaultSizeMB);
 
-        for (Move &move : allMoves)
-        {
-            Move m = board.makeMove(move.from, move.to, true);
-            int score = board.alphaBeta(depth - 1, -999999, 999999, !isWhite);
-            board.unmakeMove(m);
+        testResults.clear();
 
-            if ((isWhite && score > bestScore) || (!isWhite && score < bestScore))
-            {
-                bestScore = score;
-                bestMove = move;
-            }
+        for (const TestPosition &pos : testPositions)
+        {
+            runSingleTest(pos, maxDepth, runs);
         }
 
-        result.move = bestMove;
-        result.evaluation = bestScore;
-        return result;
+        Searcher.setThreads(threads);
+        Searcher.onIteration = onIteration;
+        TT.resize(hashMB);
     }
 
     void clearResults()
@@ -139,17 +148,25 @@ public:
         testResults.clear();
     }
 
-    std::string squareToAlgebraic(int square)
+    void printResults() const
     {
-        if (square < 0 || square > 63)
-            return "??";
+        std::cout << std::left << std::setw(28) << "Position" << std::setw(7) << "Depth" << std::setw(8) << "Move"
+                  << std::setw(8) << "Eval" << std::setw(12) << "Nodes" << std::setw(12) << "Median ms"
+                  << "Spread ms" << "\n";
+        std::cout << std::string(88, '-') << "\n";
 
-        char file = 'a' + (square % 8);
-        char rank = '1' + (square / 8);
-        return std::string(1, file) + std::string(1, rank);
+        for (const TestResult &r : testResults)
+        {
+            std::cout << std::left << std::setw(28) << r.positionName << std::setw(7) << r.depth << std::setw(8)
+                      << r.bestMove << std::setw(8) << r.evaluation << std::setw(12) << r.nodes << std::fixed
+                      << std::setprecision(2) << std::setw(12) << r.medianMs << r.minMs << " - " << r.maxMs << "\n";
+        }
+
+        std::cout << std::right << "\n";
     }
 
-    void exportToJSON(const std::string &filename)
+    // One result object per line, which is what compareWithPrevious reads back
+    void exportToJSON(const std::string &filename, int runs)
     {
         std::ofstream file(filename);
 
@@ -166,23 +183,20 @@ public:
 
         file << "{\n";
         file << "  \"timestamp\": \"" << timestamp << "\",\n";
+        file << "  \"runs\": " << runs << ",\n";
         file << "  \"total_tests\": " << testResults.size() << ",\n";
         file << "  \"results\": [\n";
 
+        file << std::fixed << std::setprecision(3);
+
         for (size_t i = 0; i < testResults.size(); i++)
         {
             const TestResult &r = testResults[i];
 
-            file << "    {\n";
-            file << "      \"position\": \"" << r.positionName << "\",\n";
-            file << "      \"depth\": " << r.depth << ",\n";
-            file << "      \"best_move_from\": " << r.bestMoveFrom << ",\n";
-            file << "      \"best_move_to\": " << r.bestMoveTo << ",\n";
-            file << "      \"best_move_algebraic\": \"" << squareToAlgebraic(r.bestMoveFrom)
-                 << " -> " << squareToAlgebraic(r.bestMoveTo) << "\",\n";
-            file << "      \"evaluation\": " << r.evaluation << ",\n";
-            file << "      \"time_ms\": " << std::fixed << std::setprecision(2) << r.timeMs << "\n";
-            file << "    }";
+            file << "    {\"position\": \"" << r.positionName << "\", \"depth\": " << r.depth
+                 << ", \"best_move\": \"" << r.bestMove << "\", \"evaluation\": " << r.evaluation
+                 << ", \"nodes\": " << r.nodes << ", \"median_ms\": " << r.medianMs << ", \"min_ms\": " << r.minMs
+                 << ", \"max_ms\": " << r.maxMs << ", \"stddev_ms\": " << r.stddevMs << "}";
 
             if (i < testResults.size() - 1)
                 file << ",";
@@ -192,42 +206,32 @@ public:
 
         file << "  ],\n";
 
-        // Calculate summary statistics
-        file << "  \"summary\": {\n";
+        // Per depth totals over all positions
+        std::map<int, double> depthMs;
+        std::map<int, uint64_t> depthNodes;
+        std::map<int, int> depthCount;
 
-        // Find max depth
-        int maxDepth = 0;
         for (const auto &r : testResults)
-            maxDepth = std::max(maxDepth, r.depth);
-
-        // Stats per depth
-        for (int depth = 1; depth <= maxDepth; depth++)
         {
-            double totalTime = 0.0;
-            int count = 0;
+            depthMs[r.depth] += r.medianMs;
+            depthNodes[r.depth] += r.nodes;
+            depthCount[r.depth]++;
+        }
 
-            for (const auto &r : testResults)
-            {
-                if (r.depth == depth)
-                {
-                    totalTime += r.timeMs;
-                    count++;
-                }
-            }
+        file << "  \"summary\": {\n";
 
-            if (count > 0)
-            {
-                file << "    \"depth_" << depth << "\": {\n";
-                file << "      \"avg_time_ms\": " << std::fixed << std::setprecision(2)
-                     << (totalTime / count) << ",\n";
-                file << "      \"positions_tested\": " << count << "\n";
-                file << "    }";
+        for (auto it = depthMs.begin(); it != depthMs.end(); ++it)
+        {
+            const int depth = it->first;
 
-                if (depth < maxDepth)
-                    file << ",";
+            file << "    \"depth_" << depth << "\": {\"total_median_ms\": " << it->second
+                 << ", \"total_nodes\": " << depthNodes[depth] << ", \"positions_tested\": " << depthCount[depth]
+                 << "}";
 
-                file << "\n";
-            }
+            if (std::next(it) != depthMs.end())
+                file << ",";
+
+            file << "\n";
         }
 
         file << "  }\n";
@@ -238,91 +242,117 @@ public:
         std::cout << "Results exported to: " << filename << std::endl;
     }
 
-    // Import and compare with previous results
-    void compareWithPrevious(const std::string &filename)
+    // Compares every position and depth with a file written by exportToJSON. A result regressed if
+    // its median time grew by more than thresholdPercent, and by more than the two runs' spread
+    // put together, so noise alone doesn't trip it. Returns false if anything regressed
+    bool compareWithPrevious(const std::string &filename, double thresholdPercent)
     {
         std::ifstream file(filename);
 
         if (!file.is_open())
         {
             std::cerr << "Failed to open file: " << filename << std::endl;
-            return;
+            return false;
         }
 
         std::cout << "\n=== Comparison with Previous Run ===\n";
         std::cout << "Previous results from: " << filename << "\n\n";
 
-        // Simple parsing - look for depth summaries
+        std::map<std::pair<std::string, int>, TestResult> previous;
         std::string line;
-        std::map<int, double> previousTimes;
 
         while (std::getline(file, line))
         {
-            // Look for "depth_N": { "avg_time_ms": X.XX
-            if (line.find("\"depth_") != std::string::npos)
-            {
-                size_t depthPos = line.find("depth_") + 6;
-                size_t endPos = line.find("\"", depthPos);
-                int depth = std::stoi(line.substr(depthPos, endPos - depthPos));
-
-                // Next line should have avg_time_ms
-                if (std::getline(file, line))
-                {
-                    size_t timePos = line.find("avg_time_ms\": ") + 14;
-                    size_t endTime = line.find(",", timePos);
-                    double time = std::stod(line.substr(timePos, endTime - timePos));
-
-                    previousTimes[depth] = time;
-                }
-            }
+            if (line.find("\"position\"") == std::string::npos)
+                continue;
+
+            TestResult r;
+            r.positionName = stringField(line, "position");
+            r.depth = (int)numberField(line, "depth");
+            r.bestMove = stringField(line, "best_move");
+            r.nodes = (uint64_t)numberField(line, "nodes");
+            r.medianMs = numberField(line, "median_ms");
+            r.minMs = numberField(line, "min_ms");
+            r.maxMs = numberField(line, "max_ms");
+
+            previous[{r.positionName, r.depth}] = r;
         }
 
         file.close();
 
-        // Compare with current results
-        std::map<int, double> currentTimes;
-        std::map<int, int> counts;
+        std::cout << std::left << std::setw(28) << "Position" << std::setw(7) << "Depth" << std::setw(15)
+                  << "Previous (ms)" << std::setw(15) << "Current (ms)" << std::setw(10) << "Speedup"
+                  << "Notes\n";
+        std::cout << std::string(90, '-') << "\n";
 
-        for (const auto &r : testResults)
-        {
-            currentTimes[r.depth] += r.timeMs;
-            counts[r.depth]++;
-        }
+        int regressions = 0;
+        double previousTotal = 0.0;
+        double currentTotal = 0.0;
 
-        for (auto &pair : currentTimes)
+        for (const TestResult &current : testResults)
         {
-            pair.second /= counts[pair.first];
-        }
+            auto it = previous.find({current.positionName, current.depth});
 
-        // Print comparison
-        std::cout << std::left << std::setw(8) << "Depth"
-                  << std::setw(15) << "Previous (ms)"
-                  << std::setw(15) << "Current (ms)"
-                  << std::setw(15) << "Speedup"
-                  << std::setw(15) << "Improvement"
-                  << "\n";
-        std::cout << std::string(65, '-') << "\n";
+            if (it == previous.end())
+                continue;
 
-        for (const auto &pair : currentTimes)
-        {
-            int depth = pair.first;
-            double current = pair.second;
+            const TestResult &old = it->second;
+            std::string notes;
 
-            if (previousTimes.count(depth))
+            previousTotal += old.medianMs;
+            currentTotal += current.medianMs;
+
+            const double spread = (old.maxMs - old.minMs) + (current.maxMs - current.minMs);
+
+            if (current.medianMs > old.medianMs * (1.0 + thresholdPercent / 100.0) &&
+                current.medianMs - old.medianMs > spread)
             {
-                double previous = previousTimes[depth];
-                double speedup = previous / current;
-                double improvement = 100.0 * (1.0 - current / previous);
-
-                std::cout << std::left << std::setw(8) << depth
-                          << std::setw(15) << std::fixed << std::setprecision(2) << previous
-                          << std::setw(15) << current
-                          << std::setw(15) << speedup << "x"
-                          << std::setw(15) << improvement << "%"
-                          << "\n";
+                notes += "REGRESSION ";
+                regressions++;
             }
+
+            // Not a failure, but the timing is no longer comparing like with like
+            if (current.nodes != old.nodes)
+                notes += "nodes " + std::to_string(old.nodes) + " -> " + std::to_string(current.nodes) + " ";
+
+            if (current.bestMove != old.bestMove)
+                notes += "move " + old.bestMove + " -> " + current.bestMove;
+
+            std::cout << std::left << std::setw(28) << current.positionName << std::setw(7) << current.depth
+                      << std::fixed << std::setprecision(2) << std::setw(15) << old.medianMs << std::setw(15)
+                      << current.medianMs << std::setw(10) << old.medianMs / std::max(current.medianMs, 0.001)
+                      << notes << "\n";
         }
 
-        std::cout << "\n";
+        std::cout << std::right << "\n";
+
+        if (currentTotal > 0.0)
+            std::cout << "Total: " << previousTotal << "ms -> " << currentTotal << "ms, speedup "
+                      << previousTotal / currentTotal << "x\n";
+
+        std::cout << regressions << " regression(s) over " << thresholdPercent << "%\n\n";
+
+        return regressions == 0;
     }
-};
\ No newline at end of file
+
+private:
+    static std::string stringField(const std::string &line, const std::string &key)
+    {
+        const std::string pattern = "\"" + key + "\": \"";
+        size_t start = line.find(pattern);
+
+        if (start == std::string::npos)
+            return "";
+
+        start += pattern.size();
+        return line.substr(start, line.find('"', start) - start);
+    }
+
+    static double numberField(const std::string &line, const std::string &key)
+    {
+        const std::string pattern = "\"" + key + "\": ";
+        const size_t start = line.find(pattern);
+
+        return start == std::string::npos ? 0.0 : std::atof(line.c_str() + start + pattern.size());
+    }
+};
@@ -3,9 +3,9 @@
 #include <iostream>
 #include <string>
 
-#include "window.h"
-#include "renderer.h"
 #include "board.h"
+#include "perft.h"
+#include "search.h"
 #include "Stopwatch.h"
 
 inline void print(std::string text)
@@ -38,6 +38,9 @@ public:
         println("1. Move Generation Test (Perft)");
         println("2. Search Performance Test (Alpha-Beta)");
         println("3. Both Tests");
+        println("4. Thread Scaling Test (Lazy SMP)");
+        println("5. Thread Scaling Test (Perft)");
+        println("6. Hashed Perft Test");
         println("");
 
         int choice;
@@ -54,6 +57,21 @@ public:
         {
             runSearchTest();
         }
+
+        if (choice == 4)
+        {
+            runThreadScalingTest();
+        }
+
+        if (choice == 5)
+        {
+            runPerftScalingTest();
+        }
+
+        if (choice == 6)
+        {
+            runPerftHashTest();
+        }
     }
 
 private:
@@ -69,7 +87,7 @@ private:
         for (int i = 1; i <= depth; i++)
         {
             sw.start();
-            int nodes = board.moveGenerationTest(i);
+            uint64_t nodes = Perft::perft(board, i);
             sw.stop();
 
             long long ms = sw.getElapsedTimeMilliseconds();
@@ -80,7 +98,7 @@ private:
 
             if (ms > 0)
             {
-                long long nps = (nodes * 1000LL) / ms;
+                uint64_t nps = nodes * 1000 / ms;
                 std::cout << " (" << nps << " nodes/sec)";
             }
 
@@ -98,60 +116,152 @@ private:
         getInt(maxDepth);
         println("");
 
-        const int infinity = 200000;
-
         for (int depth = 1; depth <= maxDepth; depth++)
         {
-            // Get legal moves
-            auto moves = MoveGen::generateLegalMoves(&board);
+            SearchLimits limits;
+            limits.depth = depth;
+
+            TT.clear();
+
+            sw.start();
+            Move bestMove = Searcher.go(board, limits);
+            sw.stop();
 
-            if (moves.empty())
+            if (bestMove == Move::none())
             {
                 println("No legal moves!");
                 break;
             }
 
-            // Order moves for better performance
-            board.orderMoves(moves);
+            long long ms = sw.getElapsedTimeMilliseconds();
 
-            int bestValue = -infinity;
-            Move bestMove;
-            int nodesSearched = 0;
+            std::cout << "Depth " << depth << ": Best move = "
+                      << board.squareToChessNotation(bestMove.from())
+                      << board.squareToChessNotation(bestMove.to())
+                      << " (eval: " << Searcher.bestWorker().bestValue << ") ";
 
-            sw.start();
+            std::cout << "Time: " << ms << "ms";
 
-            for (auto &move : moves)
+            if (ms > 0)
             {
-                board.makeMove(move);
-                int val = -board.search(depth - 1, -infinity, infinity, 1);
-                board.unmakeMove(move);
+                std::cout << " (" << (Searcher.nodes() * 1000 / ms) << " nodes/sec)";
+            }
 
-                nodesSearched++;
+            println("");
+        }
+        println("");
+    }
 
-                if (val > bestValue)
-                {
-                    bestValue = val;
-                    bestMove = move;
-                }
-            }
+    // Time to reach a fixed depth on a few middlegame positions with 1, 2, 4... threads.
+    // The TT is cleared before every search so runs don't help each other
+    void runThreadScalingTest()
+    {
+        println("--- LAZY SMP THREAD SCALING TEST ---");
 
-            sw.stop();
-            long long ms = sw.getElapsedTimeMilliseconds();
+        int depth;
+        print("Enter search depth (6-10): ");
+        getInt(depth);
 
-            std::cout << "Depth " << depth << ": Best move = "
-                      << board.squareToChessNotation(bestMove.from)
-                      << board.squareToChessNotation(bestMove.to)
-                      << " (eval: " << bestValue << ") ";
+        int maxThreads;
+        print("Enter max threads: ");
+        getInt(maxThreads);
+        println("");
 
-            std::cout << "Time: " << ms << "ms";
+        const char *fens[] = {
+            "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N2N2/PP2PPPP/R1BQKB1R w KQkq - 0 1",
+            "r2q1rk1/pp2bppp/2n1pn2/3p4/3P4/2NBPN2/PP3PPP/R2Q1RK1 w - - 0 10",
+        };
 
-            if (ms > 0)
+        long long baseMs = 0;
+
+        for (int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            Searcher.setThreads(threads);
+
+            long long totalMs = 0;
+            uint64_t totalNodes = 0;
+
+            for (const char *fen : fens)
+            {
+                Board position;
+                position.loadFen(fen);
+
+                SearchLimits limits;
+                limits.depth = depth;
+
+                TT.clear();
+
+                sw.start();
+                Searcher.go(position, limits);
+                sw.stop();
+
+                totalMs += sw.getElapsedTimeMilliseconds();
+                totalNodes += Searcher.nodes();
+            }
+
+            if (threads == 1)
+                baseMs = totalMs;
+
+            std::cout << "Threads " << threads << ": time to depth " << depth << " = " << totalMs << "ms, "
+                      << totalNodes << " nodes";
+
+            if (totalMs > 0)
             {
-                std::cout << " (" << (1000.0 / ms) << " moves/sec)";
+                std::cout << ", " << (totalNodes * 1000 / totalMs) << " nodes/sec, speedup "
+                          << double(baseMs) / totalMs << "x";
             }
 
             println("");
         }
+
+        Searcher.setThreads(1);
+        println("");
+    }
+
+    void runPerftScalingTest()
+    {
+        println("--- PERFT THREAD SCALING TEST ---");
+
+        int depth;
+        print("Enter perft depth (5-7): ");
+        getInt(depth);
+
+        int maxThreads;
+        print("Enter max threads: ");
+        getInt(maxThreads);
+        println("");
+
+        // Kiwipete, plenty of castling, en passant and promotions
+        Board position;
+        position.loadFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+        Perft::threadScaling(position, depth, maxThreads);
+        println("");
+    }
+
+    void runPerftHashTest()
+    {
+        println("--- HASHED PERFT TEST ---");
+
+        int depth;
+        print("Enter perft depth (5-7): ");
+        getInt(depth);
+
+        int threads;
+        print("Enter threads: ");
+        getInt(threads);
+
+        int hashMB;
+        print("Enter hash size in MB: ");
+        getInt(hashMB);
+        println("");
+
+        Board position;
+        position.loadFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+        Perft::hashComparison(position, depth, threads, std::max(hashMB, 1));
         println("");
     }
 };
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "engine.h"
+
+Engine::Engine(std::function<void(const EngineEvent &)> listener) : listener(std::move(listener))
+{
+    thread = std::thread([this] { loop(); });
+}
+
+Engine::~Engine()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        hasRequest = false;
+        Searcher.stop();
+    }
+
+    wake.notify_one();
+    thread.join();
+}
+
+void Engine::requestSearch(const Board &board, const SearchLimits &limits)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requestBoard = board;
+        requestLimits = limits;
+        hasRequest = true;
+        stopPending = false;
+        ponderhitPending = false;
+    }
+
+    wake.notify_one();
+}
+
+void Engine::stop()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    stopPending = hasRequest;
+    Searcher.stop();
+}
+
+void Engine::ponderhit()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ponderhitPending = hasRequest;
+    Searcher.ponderhit();
+}
+
+void Engine::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return !hasRequest && !searching; });
+}
+
+bool Engine::poll(EngineEvent &event)
+{
+    return events.pop(event);
+}
+
+void Engine::loop()
+{
+    // Progress comes from the main search thread, the best move from this one. They never
+    // overlap, since the search threads are joined before the result is published
+    Searcher.onIteration = [this](const SearchInfo &info)
+    {
+        publish({EngineEventType::Progress, info}, false);
+    };
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return hasRequest || quit; });
+
+            if (quit)
+                break;
+
+            // Started under the lock, so a stop() can't slip in before the search resets its
+            // stop flag. One that came in while the request was queued is applied now
+            Searcher.start(requestBoard, requestLimits);
+
+            if (stopPending)
+                Searcher.stop();
+            if (ponderhitPending)
+                Searcher.ponderhit();
+
+            hasRequest = false;
+            searching = true;
+        }
+
+        Searcher.wait();
+
+        const SearchWorker &best = Searcher.bestWorker();
+
+        EngineEvent result;
+        result.type = EngineEventType::BestMove;
+        result.info.depth = best.completedDepth;
+        result.info.selDepth = best.selDepth;
+        result.info.score = best.bestValue;
+        result.info.bestMove = best.bestMove;
+        result.info.pv = best.bestPv;
+        result.info.nodes = Searcher.nodes();
+        result.info.timeMs = Searcher.timeManager.elapsedMs();
+        result.info.hashfull = TT.hashfull();
+
+        publish(result, true);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            searching = false;
+        }
+
+        idle.notify_all();
+    }
+
+    Searcher.onIteration = nullptr;
+}
+
+// Progress is dropped if the consumer has fallen behind, the final move waits for room
+void Engine::publish(const EngineEvent &event, bool mustDeliver)
+{
+    if (listener)
+    {
+        listener(event);
+        return;
+    }
+
+    while (!events.push(event))
+    {
+        if (!mustDeliver || quit)
+            return;
+
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "board.h"
+#include "search.h"
+#include "spsc_queue.h"
+
+enum class EngineEventType
+{
+    Progress, // An iteration finished, info holds its result
+    BestMove, // The search is over, info.bestMove is the move to play (none if there was none)
+};
+
+struct EngineEvent
+{
+    EngineEventType type = EngineEventType::Progress;
+    SearchInfo info;
+};
+
+// Runs searches on a background thread so the caller (the GUI's render loop) never waits.
+// Requests go in through requestSearch, results come back as events from poll, or
+// straight to a listener callback on the engine thread if one was given
+class Engine
+{
+public:
+    Engine() : Engine(nullptr) {}
+    explicit Engine(std::function<void(const EngineEvent &)> listener);
+    ~Engine();
+
+    Engine(const Engine &) = delete;
+    Engine &operator=(const Engine &) = delete;
+
+    // Queue a search of a copy of board. Replaces a request that hasn't started yet
+    void requestSearch(const Board &board, const SearchLimits &limits);
+
+    // Stop the search early. It still reports a best move, even if it hadn't started yet
+    void stop();
+
+    // Forwarded to Search::ponderhit, or held for a search that hasn't started yet
+    void ponderhit();
+
+    // Block until no search is queued or running
+    void waitUntilIdle();
+
+    // Next progress or best move event, if any. Only ever call from one thread
+    bool poll(EngineEvent &event);
+
+private:
+    void loop();
+    void publish(const EngineEvent &event, bool mustDeliver);
+
+    std::function<void(const EngineEvent &)> listener;
+    std::thread thread;
+
+    // Guards the request and busy state only, never held while searching
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    bool hasRequest = false;
+    bool searching = false;
+    bool stopPending = false;
+    bool ponderhitPending = false;
+    std::atomic<bool> quit{false};
+    Board requestBoard;
+    SearchLimits requestLimits;
+
+    SpscQueue<EngineEvent, 256> events;
+};
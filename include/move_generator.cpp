@@ -3,36 +3,35 @@
 #include "move_generator.h"
 #include "board.h"
 
-std::vector<Move> MoveGen::generateLegalMoves(Board *board, bool onlyGenCaptures)
+using namespace Bitboards;
+
+void MoveGen::generateLegalMoves(const Board *board, MoveList &moves, bool onlyGenCaptures)
 {
-    generateMoves(board);
+    moves.clear();
 
-    std::vector<Move> legal;
-    legal.reserve(moves.size());
+    const CheckInfo info = computeCheckInfo(board);
+    const Bitboard enemies = board->colourBitboards[board->isWhiteTurn ? Black : White];
+    const Bitboard targetMask = onlyGenCaptures ? enemies : ~0ULL;
 
-    for (auto &move : moves)
+    // In double check only the king can move
+    if (popCount(info.checkers) < 2)
     {
-        if (onlyGenCaptures && board->pieces[move.to].type == None && !move.wasEnPassant && !move.wasPromotion)
-            continue;
-
-        board->makeMove(move);
-        const int ourKing = board->isWhiteTurn ? board->pieceList.blackKing : board->pieceList.whiteKing;
-
-        if (!isSquareAttacked(board, ourKing, board->isWhiteTurn))
-        {
-            legal.push_back(move);
-        }
+        // Knights (simplest first)
+        generatePieceMoves(board, moves, Knight, info, targetMask);
+        generatePieceMoves(board, moves, Bishop, info, targetMask);
+        generatePieceMoves(board, moves, Rook, info, targetMask);
+        generatePieceMoves(board, moves, Queen, info, targetMask);
 
-        board->unmakeMove(move);
+        // Pawns (most complex last)
+        generatePawnMoves(board, moves, info, onlyGenCaptures);
     }
 
-    /*if (legal.empty() && !onlyGenCaptures)
+    generateKingMoves(board, moves, info, targetMask);
+
+    /*if (moves.empty() && !onlyGenCaptures)
     {
         // Check if king is in check
-        int ourKing = board->isWhiteTurn ? board->pieceList.whiteKing : board->pieceList.blackKing;
-        bool inCheck = isSquareAttacked(board, ourKing, !board->isWhiteTurn);
-
-        if (inCheck)
+        if (info.checkers)
         {
             board->checkmate = board->isWhiteTurn ? 1 : 0; // Checkmate
         }
@@ -41,380 +40,249 @@ std::vector<Move> MoveGen::generateLegalMoves(Board *board, bool onlyGenCaptures
             board->checkmate = 2; // Stalemate
         }
     }*/
-
-    return legal;
 }
 
-bool MoveGen::isSquareAttacked(const Board *board, int square, bool byWhite)
+MoveGen::CheckInfo MoveGen::computeCheckInfo(const Board *board)
 {
-    const auto &pieces = board->pieces;
-    const int squareFile = square & 7;  // Faster than getFile
-    const int squareRank = square >> 3; // Faster than getRank
+    CheckInfo info;
 
-    // Check pawns - most common, check first
-    const int pawnDir = byWhite ? -8 : 8;
+    const bool isWhite = board->isWhiteTurn;
+    const int kingSquare = board->kingSquare(isWhite);
 
-    int sq = square + pawnDir - 1;
-    if (sq >= 0 && sq < 64 && abs((sq & 7) - squareFile) == 1)
-    {
-        const Piece &p = pieces[sq];
-        if (p.type == Pawn && p.isWhite == byWhite)
-            return true;
-    }
+    if (kingSquare < 0)
+        return info;
+
+    const Bitboard friendly = board->colourBitboards[isWhite ? White : Black];
+    const Bitboard enemies = board->colourBitboards[isWhite ? Black : White];
+    const Bitboard queens = board->pieceBitboards[Queen];
+
+    info.checkers = attackersTo(board, kingSquare, board->allPieces) & enemies;
 
-    sq = square + pawnDir + 1;
-    if (sq >= 0 && sq < 64 && abs((sq & 7) - squareFile) == 1)
+    if (info.checkers && popCount(info.checkers) == 1)
     {
-        const Piece &p = pieces[sq];
-        if (p.type == Pawn && p.isWhite == byWhite)
-            return true;
+        // Block the ray or capture the checker (betweenBB is empty for knights and pawns)
+        const int checker = lsb(info.checkers);
+        info.checkMask = betweenBB[kingSquare][checker] | info.checkers;
     }
 
-    // Check knights - second most common
-    static const int knightMoves[8] = {17, 15, 10, 6, -6, -10, -15, -17};
-    for (int offset : knightMoves)
-    {
-        sq = square + offset;
-        if (sq < 0 || sq >= 64)
-            continue;
+    // Enemy sliders that would hit our king if exactly one of our pieces weren't in the way
+    Bitboard snipers = ((attacks<Rook>(kingSquare, 0) & (board->pieceBitboards[Rook] | queens)) |
+                        (attacks<Bishop>(kingSquare, 0) & (board->pieceBitboards[Bishop] | queens))) &
+                       enemies;
 
-        const int fd = abs((sq & 7) - squareFile);
-        const int rd = abs((sq >> 3) - squareRank);
+    while (snipers)
+    {
+        const Bitboard blockers = betweenBB[kingSquare][popLsb(snipers)] & board->allPieces;
 
-        if ((fd == 2 && rd == 1) || (fd == 1 && rd == 2))
-        {
-            const Piece &p = pieces[sq];
-            if (p.type == Knight && p.isWhite == byWhite)
-                return true;
-        }
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & friendly))
+            info.pinned |= blockers;
     }
 
-    // Check king
-    for (int direction = 0; direction < 8; direction++)
-    {
-        sq = square + directionOffsets[direction];
-        if (sq < 0 || sq >= 64)
-            continue;
+    info.kingDanger = attackedSquares(board, !isWhite, board->allPieces ^ squareBB(kingSquare));
 
-        const int fd = abs((sq & 7) - squareFile);
-        const int rd = abs((sq >> 3) - squareRank);
+    return info;
+}
 
-        if (fd <= 1 && rd <= 1)
-        {
-            const Piece &p = pieces[sq];
-            if (p.type == King && p.isWhite == byWhite)
-                return true;
-        }
-    }
+void MoveGen::generatePieceMoves(const Board *board, MoveList &moves, PieceType type, const CheckInfo &info, Bitboard targetMask)
+{
+    const Bitboard friendly = board->colourBitboards[board->isWhiteTurn ? White : Black];
+    const int kingSquare = board->kingSquare(board->isWhiteTurn);
 
-    // Check sliding pieces
-    for (int direction = 0; direction < 8; direction++)
-    {
-        const int offset = directionOffsets[direction];
-        const int maxSteps = numSquaresToEdge[square][direction];
+    // A pinned knight can never stay on the pin line
+    Bitboard pieces = board->pieceBitboards[type] & friendly;
+    if (type == Knight)
+        pieces &= ~info.pinned;
 
-        for (int n = 0; n < maxSteps; n++)
-        {
-            sq = square + offset * (n + 1);
-            const Piece &piece = pieces[sq];
+    // Can't capture own piece, and must resolve any check
+    targetMask &= ~friendly & info.checkMask;
 
-            if (piece.type == None)
-                continue;
+    while (pieces)
+    {
+        const int startSquare = popLsb(pieces);
 
-            if (piece.isWhite == byWhite)
-            {
-                const bool isOrthogonal = direction < 4;
-
-                if (isOrthogonal)
-                {
-                    if (piece.type == Rook || piece.type == Queen)
-                        return true;
-                }
-                else
-                {
-                    if (piece.type == Bishop || piece.type == Queen)
-                        return true;
-                }
-            }
+        Bitboard targets = attacks(type, startSquare, board->allPieces) & targetMask;
 
-            break;
-        }
-    }
+        if (info.pinned & squareBB(startSquare))
+            targets &= lineBB[kingSquare][startSquare];
 
-    return false;
+        while (targets)
+            moves.push_back(Move(startSquare, popLsb(targets)));
+    }
 }
 
-std::vector<Move> MoveGen::generateMoves(const Board *board)
+void MoveGen::generateKingMoves(const Board *board, MoveList &moves, const CheckInfo &info, Bitboard targetMask)
 {
-    moves.clear();
-    moves.reserve(50);
-
-    const PieceList &pl = board->pieceList;
+    const bool isWhite = board->isWhiteTurn;
+    const int startSquare = board->kingSquare(isWhite);
 
-    if (board->isWhiteTurn)
-    {
-        // Knights (simplest first)
-        for (int sq : pl.whiteKnights)
-            generateKnightMoves(board, sq, board->pieces[sq]);
+    if (startSquare < 0)
+        return;
 
-        // Bishops
-        for (int sq : pl.whiteBishops)
-            generateSlidingMoves(board, sq, board->pieces[sq]);
+    Bitboard targets = attacks<King>(startSquare, 0) & ~board->colourBitboards[isWhite ? White : Black] &
+                       ~info.kingDanger & targetMask;
 
-        // Rooks
-        for (int sq : pl.whiteRooks)
-            generateSlidingMoves(board, sq, board->pieces[sq]);
+    while (targets)
+        moves.push_back(Move(startSquare, popLsb(targets)));
 
-        // Queens
-        for (int sq : pl.whiteQueens)
-            generateSlidingMoves(board, sq, board->pieces[sq]);
+    // Castling is never a capture, and is illegal out of check
+    if (targetMask != ~0ULL || info.checkers)
+        return;
 
-        // King
-        if (pl.whiteKing != -1)
-            generateKingMoves(board, pl.whiteKing, board->pieces[pl.whiteKing]);
+    const int kingsideRight = isWhite ? WhiteKingside : BlackKingside;
+    const int queensideRight = isWhite ? WhiteQueenside : BlackQueenside;
+    const int backRank = isWhite ? 0 : 56;
 
-        // Pawns (most complex last)
-        for (int sq : pl.whitePawns)
-            generatePawnMoves(board, sq, board->pieces[sq]);
-    }
-    else
+    // Kingside castling
+    if (board->castlingRights & kingsideRight)
     {
-        for (int sq : pl.blackKnights)
-            generateKnightMoves(board, sq, board->pieces[sq]);
-
-        for (int sq : pl.blackBishops)
-            generateSlidingMoves(board, sq, board->pieces[sq]);
-
-        for (int sq : pl.blackRooks)
-            generateSlidingMoves(board, sq, board->pieces[sq]);
+        // f and g files must be empty, and the king can't pass through or land on an attacked square
+        const Bitboard path = squareBB(backRank + 5) | squareBB(backRank + 6);
 
-        for (int sq : pl.blackQueens)
-            generateSlidingMoves(board, sq, board->pieces[sq]);
+        if (!(board->allPieces & path) && !(info.kingDanger & path))
+            moves.push_back(Move(startSquare, startSquare + 2, CastlingMove));
+    }
 
-        if (pl.blackKing != -1)
-            generateKingMoves(board, pl.blackKing, board->pieces[pl.blackKing]);
+    // Queenside castling
+    if (board->castlingRights & queensideRight)
+    {
+        // b, c and d files must be empty, but only c and d need to be safe
+        const Bitboard path = squareBB(backRank + 1) | squareBB(backRank + 2) | squareBB(backRank + 3);
+        const Bitboard kingPath = squareBB(backRank + 2) | squareBB(backRank + 3);
 
-        for (int sq : pl.blackPawns)
-            generatePawnMoves(board, sq, board->pieces[sq]);
+        if (!(board->allPieces & path) && !(info.kingDanger & kingPath))
+            moves.push_back(Move(startSquare, startSquare - 2, CastlingMove));
     }
-
-    return moves;
 }
 
-void MoveGen::generateSlidingMoves(const Board *board, int startSquare, const Piece &piece)
+void MoveGen::generatePawnMoves(const Board *board, MoveList &moves, const CheckInfo &info, bool onlyGenCaptures)
 {
-    const int startDir = piece.type == Bishop ? 4 : 0;
-    const int endDir = piece.type == Rook ? 4 : 8;
-    const bool isWhite = piece.isWhite;
-    const auto &pieces = board->pieces;
+    const bool isWhite = board->isWhiteTurn;
+    const int kingSquare = board->kingSquare(isWhite);
+    const Bitboard pawns = board->pieceBitboards[Pawn] & board->colourBitboards[isWhite ? White : Black];
+    const Bitboard enemies = board->colourBitboards[isWhite ? Black : White];
+    const Bitboard empty = ~board->allPieces;
 
-    for (int direction = startDir; direction < endDir; direction++)
+    // Pawns on the 7th rank (white) or 2nd rank (black) promote when they move
+    const Bitboard promotionRank = isWhite ? Rank7 : Rank2;
+    const int up = isWhite ? 8 : -8;
+
+    auto pushPawnMoves = [&](Bitboard targets, int offset, bool promoting)
     {
-        const int offset = directionOffsets[direction];
-        const int maxSteps = numSquaresToEdge[startSquare][direction];
+        targets &= info.checkMask;
 
-        for (int n = 0; n < maxSteps; n++)
+        while (targets)
         {
-            const int targetSquare = startSquare + offset * (n + 1);
-            const Piece &targetPiece = pieces[targetSquare];
-
-            // Blocked by own piece
-            if (targetPiece.type != None && targetPiece.isWhite == isWhite)
-                break;
+            const int targetSquare = popLsb(targets);
+            const int startSquare = targetSquare - offset;
 
-            moves.push_back(Move(startSquare, targetSquare));
+            // Pinned pawns may only move along the pin
+            if ((info.pinned & squareBB(startSquare)) && !(lineBB[kingSquare][startSquare] & squareBB(targetSquare)))
+                continue;
 
-            // Blocked by opponent piece (capture, but can't move further)
-            if (targetPiece.type != None)
-                break;
+            if (promoting)
+            {
+                // Add all 4 promotion options
+                moves.push_back(Move(startSquare, targetSquare, PromotionMove, Queen));
+                moves.push_back(Move(startSquare, targetSquare, PromotionMove, Rook));
+                moves.push_back(Move(startSquare, targetSquare, PromotionMove, Bishop));
+                moves.push_back(Move(startSquare, targetSquare, PromotionMove, Knight));
+            }
+            else
+            {
+                moves.push_back(Move(startSquare, targetSquare));
+            }
         }
-    }
-}
+    };
 
-void MoveGen::generateKnightMoves(const Board *board, int startSquare, const Piece &piece)
-{
-    const int startFile = getFile(startSquare);
-    const int startRank = getRank(startSquare);
-    const bool isWhite = piece.isWhite;
-    const auto &pieces = board->pieces;
-
-    for (int i = 0; i < 8; i++)
+    for (int promoting = 0; promoting < 2; promoting++)
     {
-        const int targetSquare = startSquare + knightOffsets[i];
-
-        // Check if move is within board bounds
-        if (targetSquare < 0 || targetSquare >= 64)
-            continue;
-
-        const int fileDiff = abs(getFile(targetSquare) - startFile);
-        const int rankDiff = abs(getRank(targetSquare) - startRank);
+        const Bitboard movers = pawns & (promoting ? promotionRank : ~promotionRank);
 
-        // Check if knight didn't wrap around the board
-        if (!((fileDiff == 2 && rankDiff == 1) || (fileDiff == 1 && rankDiff == 2)))
-            continue;
+        // Forward one square. Captures-only generation still includes the promotions
+        const Bitboard singlePushes = (isWhite ? shiftNorth(movers) : shiftSouth(movers)) & empty;
 
-        const Piece &targetPiece = pieces[targetSquare];
+        if (promoting || !onlyGenCaptures)
+            pushPawnMoves(singlePushes, up, promoting);
 
-        // Can't capture own piece
-        if (targetPiece.type != None && targetPiece.isWhite == isWhite)
-            continue;
+        // Forward two squares from the start rank, via an empty square on the 3rd (white) or 6th (black) rank
+        if (!promoting && !onlyGenCaptures)
+        {
+            const Bitboard thirdRank = singlePushes & (isWhite ? Rank3 : Rank6);
+            const Bitboard doublePushes = (isWhite ? shiftNorth(thirdRank) : shiftSouth(thirdRank)) & empty;
+            pushPawnMoves(doublePushes, up * 2, false);
+        }
 
-        moves.push_back(Move(startSquare, targetSquare));
+        // Diagonal captures
+        const Bitboard eastCaptures = (isWhite ? shiftNorthEast(movers) : shiftSouthEast(movers)) & enemies;
+        const Bitboard westCaptures = (isWhite ? shiftNorthWest(movers) : shiftSouthWest(movers)) & enemies;
+        pushPawnMoves(eastCaptures, isWhite ? 9 : -7, promoting);
+        pushPawnMoves(westCaptures, isWhite ? 7 : -9, promoting);
     }
-}
-
-void MoveGen::generateKingMoves(const Board *board, int startSquare, const Piece &piece)
-{
-    const int startFile = getFile(startSquare);
-    const int startRank = getRank(startSquare);
-    const bool isWhite = piece.isWhite;
-    const auto &pieces = board->pieces;
 
-    // King moves one square in any direction
-    for (int direction = 0; direction < 8; direction++)
+    // En Passant
+    if (board->enPassantSquare != -1)
     {
-        const int targetSquare = startSquare + directionOffsets[direction];
-
-        if (targetSquare < 0 || targetSquare >= 64)
-            continue;
-
-        const int fileDiff = abs(getFile(targetSquare) - startFile);
-        const int rankDiff = abs(getRank(targetSquare) - startRank);
-
-        if (fileDiff > 1 || rankDiff > 1)
-            continue;
+        const int epSquare = board->enPassantSquare;
+        const int capturedPawnSquare = epSquare - up;
+        const Bitboard enemySliders = board->pieceBitboards[Rook] | board->pieceBitboards[Bishop] | board->pieceBitboards[Queen];
 
-        const Piece &targetPiece = pieces[targetSquare];
+        // A knight or a pawn other than the one being captured still gives check afterwards
+        if (info.checkers & ~squareBB(capturedPawnSquare) & ~enemySliders)
+            return;
 
-        if (targetPiece.type != None && targetPiece.isWhite == isWhite)
-            continue;
+        Bitboard attackers = pawnAttacks[isWhite ? Black : White][epSquare] & pawns;
 
-        moves.push_back(Move(startSquare, targetSquare));
-    }
+        while (attackers)
+        {
+            const int startSquare = popLsb(attackers);
 
-    // Castling - with proper check detection
-    if (piece.hasMoved)
-        return;
+            // Two pawns leave the same rank at once, so pins can't be read off info.pinned.
+            // Replay the capture on the occupancy and look for any slider that now sees the king
+            const Bitboard occupied = (board->allPieces ^ squareBB(startSquare) ^ squareBB(capturedPawnSquare)) | squareBB(epSquare);
+            const Bitboard queens = board->pieceBitboards[Queen];
 
-    const int backRank = isWhite ? 0 : 56;
-
-    // Can't castle if currently in check
-    if (isSquareAttacked(board, startSquare, !isWhite))
-        return;
+            if ((attacks<Rook>(kingSquare, occupied) & (board->pieceBitboards[Rook] | queens) & enemies) ||
+                (attacks<Bishop>(kingSquare, occupied) & (board->pieceBitboards[Bishop] | queens) & enemies))
+                continue;
 
-    // Kingside castling
-    const Piece &kingsideRook = pieces[backRank + 7];
-    if (kingsideRook.type == Rook && !kingsideRook.hasMoved)
-    {
-        // Check if f and g files are empty
-        if (pieces[backRank + 5].type == None &&
-            pieces[backRank + 6].type == None)
-        {
-            // Check if king doesn't move THROUGH check (f file)
-            if (!isSquareAttacked(board, backRank + 5, !isWhite))
-            {
-                // Check if king doesn't END in check is handled by generateLegalMoves
-                moves.push_back(Move(startSquare, startSquare + 2, true));
-            }
-        }
-    }
-
-    // Queenside castling
-    const Piece &queensideRook = pieces[backRank + 0];
-    if (queensideRook.type == Rook && !queensideRook.hasMoved)
-    {
-        // Check if b, c, and d files are empty
-        if (pieces[backRank + 1].type == None &&
-            pieces[backRank + 2].type == None &&
-            pieces[backRank + 3].type == None)
-        {
-            // Check if king doesn't move THROUGH check (c file)
-            if (!isSquareAttacked(board, backRank + 3, !isWhite))
-            {
-                // Check if king doesn't END in check is handled by generateLegalMoves
-                moves.push_back(Move(startSquare, startSquare - 2, true));
-            }
+            moves.push_back(Move(startSquare, epSquare, EnPassantMove));
         }
     }
 }
 
-void MoveGen::generatePawnMoves(const Board *board, int startSquare, const Piece &piece)
+Bitboard MoveGen::attackersTo(const Board *board, int square, Bitboard occupied)
 {
-    const int startFile = getFile(startSquare);
-    const int startRank = getRank(startSquare);
-    const bool isWhite = piece.isWhite;
-    const int direction = isWhite ? 8 : -8;
-    const auto &pieces = board->pieces;
-
-    // Check if pawn is on the 7th rank (white) or 2nd rank (black)
-    const int promotionRank = isWhite ? 6 : 1; // Rank before promotion
-    const bool willPromote = (startRank == promotionRank);
-
-    // Forward one square
-    const int oneForward = startSquare + direction;
-    if (oneForward >= 0 && oneForward < 64 && pieces[oneForward].type == None)
-    {
-        if (willPromote)
-        {
-            // Add all 4 promotion options
-            moves.push_back(Move(startSquare, oneForward, false, Queen));
-            moves.push_back(Move(startSquare, oneForward, false, Rook));
-            moves.push_back(Move(startSquare, oneForward, false, Bishop));
-            moves.push_back(Move(startSquare, oneForward, false, Knight));
-        }
-        else
-        {
-            moves.push_back(Move(startSquare, oneForward));
-
-            const bool isStartRank = isWhite ? (startRank == 1) : (startRank == 6);
+    const Bitboard queens = board->pieceBitboards[Queen];
+
+    // A pawn attacks a square if a pawn of the other colour standing there would attack it back
+    return (pawnAttacks[Black][square] & board->pieceBitboards[Pawn] & board->colourBitboards[White]) |
+           (pawnAttacks[White][square] & board->pieceBitboards[Pawn] & board->colourBitboards[Black]) |
+           (attacks<Knight>(square, occupied) & board->pieceBitboards[Knight]) |
+           (attacks<King>(square, occupied) & board->pieceBitboards[King]) |
+           (attacks<Bishop>(square, occupied) & (board->pieceBitboards[Bishop] | queens)) |
+           (attacks<Rook>(square, occupied) & (board->pieceBitboards[Rook] | queens));
+}
 
-            if (isStartRank)
-            {
-                const int twoForward = startSquare + direction * 2;
-                if (pieces[twoForward].type == None)
-                {
-                    moves.push_back(Move(startSquare, twoForward));
-                }
-            }
-        }
-    }
+Bitboard MoveGen::attackedSquares(const Board *board, bool byWhite, Bitboard occupied)
+{
+    const Bitboard attackers = board->colourBitboards[byWhite ? White : Black];
+    const Bitboard pawns = board->pieceBitboards[Pawn] & attackers;
 
-    // Diagonal captures
-    const int captureOffsets[2] = {direction + 1, direction - 1};
+    Bitboard attacked = byWhite ? shiftNorthEast(pawns) | shiftNorthWest(pawns)
+                                : shiftSouthEast(pawns) | shiftSouthWest(pawns);
 
-    for (int offset : captureOffsets)
+    for (PieceType type : {Knight, Bishop, Rook, Queen, King})
     {
-        const int targetSquare = startSquare + offset;
-
-        if (targetSquare < 0 || targetSquare >= 64)
-            continue;
+        Bitboard pieces = board->pieceBitboards[type] & attackers;
 
-        // Check if we didn't wrap around the board
-        if (abs(getFile(targetSquare) - startFile) != 1)
-            continue;
+        while (pieces)
+            attacked |= attacks(type, popLsb(pieces), occupied);
+    }
 
-        const Piece &targetPiece = pieces[targetSquare];
+    return attacked;
+}
 
-        // Can capture enemy piece
-        if (targetPiece.type != None && targetPiece.isWhite != isWhite)
-        {
-            if (willPromote)
-            {
-                // Add all 4 promotion options for captures
-                moves.push_back(Move(startSquare, targetSquare, false, Queen));
-                moves.push_back(Move(startSquare, targetSquare, false, Rook));
-                moves.push_back(Move(startSquare, targetSquare, false, Bishop));
-                moves.push_back(Move(startSquare, targetSquare, false, Knight));
-            }
-            else
-            {
-                moves.push_back(Move(startSquare, targetSquare));
-            }
-        }
-        // En Passant
-        else if (targetSquare == board->enPassantSquare)
-        {
-            moves.push_back(Move(startSquare, targetSquare));
-        }
-    }
-}
\ No newline at end of file
+bool MoveGen::isSquareAttacked(const Board *board, int square, bool byWhite)
+{
+    return attackersTo(board, square, board->allPieces) & board->colourBitboards[byWhite ? White : Black];
+}
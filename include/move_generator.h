@@ -5,37 +5,75 @@
 #include <vector>
 
 #include "piece.h"
+#include "bitboard.h"
 
 class Board;
 
+enum MoveFlag
+{
+    NormalMove = 0,
+    PromotionMove = 1 << 14,
+    EnPassantMove = 2 << 14,
+    CastlingMove = 3 << 14,
+};
+
+// A move packed into 16 bits: from square (bits 0-5), to square (6-11),
+// promotion piece minus Knight (12-13) and MoveFlag (14-15).
+// Everything needed to take the move back lives in the board's StateInfo stack
 struct Move
 {
-    int from;
-    int to;
-    bool castling;
-
-    // State needed for unmake
-    Piece capturedPiece;
-    int prevEnPassant;
-    bool wasEnPassant;
-    int epCapturedSquare;
-    Piece epCapturedPiece;
-    bool movedPieceHadMoved;
-    bool rookHadMoved;
-    bool wasPromotion;
-    PieceType promotionPiece;
-
-    Move(int f = -1, int t = -1, bool c = false, PieceType promo = Queen) noexcept
-        : from(f), to(t), castling(c),
-          capturedPiece(),
-          prevEnPassant(-1),
-          wasEnPassant(false),
-          epCapturedSquare(-1),
-          epCapturedPiece(),
-          movedPieceHadMoved(false),
-          rookHadMoved(false),
-          wasPromotion(false),
-          promotionPiece(promo) {} // FIX: Initialize wasPromotion!
+    uint16_t data = 0;
+
+    constexpr Move() = default;
+    constexpr explicit Move(uint16_t raw) : data(raw) {}
+
+    constexpr Move(int from, int to, MoveFlag flag = NormalMove, PieceType promotion = Knight)
+        : data(uint16_t(from | (to << 6) | ((promotion - Knight) << 12) | flag)) {}
+
+    constexpr int from() const { return data & 0x3F; }
+    constexpr int to() const { return (data >> 6) & 0x3F; }
+    constexpr MoveFlag flag() const { return MoveFlag(data & (3 << 14)); }
+    constexpr PieceType promotionPiece() const { return PieceType(Knight + ((data >> 12) & 3)); }
+
+    constexpr bool isPromotion() const { return flag() == PromotionMove; }
+    constexpr bool isEnPassant() const { return flag() == EnPassantMove; }
+    constexpr bool isCastling() const { return flag() == CastlingMove; }
+
+    // a1a1 is never a legal move, so the all-zero encoding doubles as "no move"
+    static constexpr Move none() { return Move(); }
+
+    constexpr bool operator==(const Move &other) const { return data == other.data; }
+    constexpr bool operator!=(const Move &other) const { return data != other.data; }
+};
+
+// Fixed-capacity move buffer meant to live on the stack, so generating moves never touches the heap.
+// 218 is the most legal moves any reachable position has
+struct MoveList
+{
+    static constexpr int Capacity = 256;
+
+    // Left uninitialised: only the first count entries are ever read
+    union
+    {
+        Move moves[Capacity];
+    };
+    int count = 0;
+
+    MoveList() {}
+
+    void push_back(const Move &move) { moves[count++] = move; }
+    void clear() { count = 0; }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move &operator[](int i) { return moves[i]; }
+    const Move &operator[](int i) const { return moves[i]; }
+
+    Move *begin() { return moves; }
+    Move *end() { return moves + count; }
+    const Move *begin() const { return moves; }
+    const Move *end() const { return moves + count; }
 };
 
 namespace MoveGen
@@ -79,21 +117,31 @@ namespace MoveGen
                         std::min(south, west)};
             }
         }
-    }
 
-    // --- RUNTIME DATA ---
-    inline std::vector<Move> moves;
+        Bitboards::init();
+    }
 
     // Helper functions
     inline constexpr int getFile(int square) { return square & 7; }
     inline constexpr int getRank(int square) { return square >> 3; }
 
+    // Legality information for the side to move, computed once per node
+    struct CheckInfo
+    {
+        Bitboard checkers = 0;      // Enemy pieces giving check
+        Bitboard pinned = 0;        // Our pieces that may only move along the line through our king
+        Bitboard checkMask = ~0ULL; // Squares a non-king move must land on to resolve a check
+        Bitboard kingDanger = 0;    // Squares the enemy attacks, seen through our king so it can't step back along a ray
+    };
+
     // Move generation functions
-    std::vector<Move> generateLegalMoves(Board *board, bool onlyGenCaptures = false);
-    std::vector<Move> generateMoves(const Board *board);
-    void generateSlidingMoves(const Board *board, int startSquare, const Piece &piece);
-    void generateKnightMoves(const Board *board, int startSquare, const Piece &piece);
-    void generateKingMoves(const Board *board, int startSquare, const Piece &piece);
-    void generatePawnMoves(const Board *board, int startSquare, const Piece &piece);
+    // onlyGenCaptures keeps captures and promotions, the moves quiescence search looks at
+    void generateLegalMoves(const Board *board, MoveList &moves, bool onlyGenCaptures = false);
+    CheckInfo computeCheckInfo(const Board *board);
+    void generatePieceMoves(const Board *board, MoveList &moves, PieceType type, const CheckInfo &info, Bitboard targetMask);
+    void generateKingMoves(const Board *board, MoveList &moves, const CheckInfo &info, Bitboard targetMask);
+    void generatePawnMoves(const Board *board, MoveList &moves, const CheckInfo &info, bool onlyGenCaptures);
+    Bitboard attackersTo(const Board *board, int square, Bitboard occupied);
+    Bitboard attackedSquares(const Board *board, bool byWhite, Bitboard occupied);
     bool isSquareAttacked(const Board *board, int square, bool byWhite);
 };
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "perft.h"
+#include "move_generator.h"
+#include "Stopwatch.h"
+
+uint64_t Perft::perft(Board &board, int depth)
+{
+    if (depth == 0)
+        return 1;
+
+    MoveList moves;
+    MoveGen::generateLegalMoves(&board, moves);
+
+    if (depth == 1)
+        return moves.size();
+
+    uint64_t nodes = 0;
+
+    for (const Move &move : moves)
+    {
+        board.makeMove(move);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove(move);
+    }
+
+    return nodes;
+}
+
+void PerftTable::resize(size_t megabytes)
+{
+    bucketCount = megabytes * 1024 * 1024 / sizeof(Bucket);
+    if (bucketCount == 0)
+        bucketCount = 1;
+
+    buckets.reset(new Bucket[bucketCount]);
+    clear();
+}
+
+void PerftTable::clear()
+{
+    std::memset(static_cast<void *>(buckets.get()), 0, bucketCount * sizeof(Bucket));
+    probeCount = 0;
+    hitCount = 0;
+}
+
+// An empty entry reads as depth 0, which is never probed, so it can't produce a false hit
+bool PerftTable::probe(uint64_t key, int depth, uint64_t &nodes) const
+{
+    const Bucket *bucket = bucketFor(key);
+
+    for (const Entry *entry : {&bucket->deep, &bucket->recent})
+    {
+        const uint64_t data = entry->data.load(std::memory_order_relaxed);
+
+        if ((entry->keyXorData.load(std::memory_order_relaxed) ^ data) == key && int(data >> 56) == depth)
+        {
+            nodes = data & ((1ULL << 56) - 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void PerftTable::store(uint64_t key, int depth, uint64_t nodes)
+{
+    Bucket *bucket = bucketFor(key);
+    const uint64_t data = nodes | uint64_t(depth) << 56;
+
+    Entry *entry = int(bucket->deep.data.load(std::memory_order_relaxed) >> 56) <= depth ? &bucket->deep : &bucket->recent;
+
+    entry->keyXorData.store(key ^ data, std::memory_order_relaxed);
+    entry->data.store(data, std::memory_order_relaxed);
+}
+
+void PerftTable::addStats(uint64_t probes, uint64_t hits)
+{
+    probeCount.fetch_add(probes, std::memory_order_relaxed);
+    hitCount.fetch_add(hits, std::memory_order_relaxed);
+}
+
+namespace
+{
+    struct HashStats
+    {
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+    };
+
+    uint64_t hashedPerft(Board &board, int depth, PerftTable &table, HashStats &stats)
+    {
+        MoveList moves;
+
+        if (depth < 2)
+        {
+            if (depth == 0)
+                return 1;
+
+            MoveGen::generateLegalMoves(&board, moves);
+            return moves.size();
+        }
+
+        uint64_t nodes = 0;
+
+        stats.probes++;
+        if (table.probe(board.key, depth, nodes))
+        {
+            stats.hits++;
+            return nodes;
+        }
+
+        MoveGen::generateLegalMoves(&board, moves);
+
+        for (const Move &move : moves)
+        {
+            board.makeMove(move);
+            nodes += hashedPerft(board, depth - 1, table, stats);
+            board.unmakeMove(move);
+        }
+
+        table.store(board.key, depth, nodes);
+        return nodes;
+    }
+
+    uint64_t subtreeCount(Board &board, int depth, PerftTable *table, HashStats &stats)
+    {
+        return table ? hashedPerft(board, depth, *table, stats) : Perft::perft(board, depth);
+    }
+
+    struct Task
+    {
+        int rootIndex;
+        Move root;
+        Move reply;
+    };
+
+    // One thread's share of the tasks. The owner and thieves both take from the front, so a
+    // single counter is all the synchronisation there is
+    struct alignas(64) Batch
+    {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+}
+
+uint64_t Perft::perft(Board &board, int depth, PerftTable &table)
+{
+    HashStats stats;
+    const uint64_t nodes = hashedPerft(board, depth, table, stats);
+
+    table.addStats(stats.probes, stats.hits);
+    return nodes;
+}
+
+uint64_t Perft::parallelPerft(const Board &board, int depth, int threads, std::vector<uint64_t> *moveCounts,
+                              PerftTable *table)
+{
+    if (depth <= 0)
+        return 1;
+
+    Board root = board;
+
+    MoveList moves;
+    MoveGen::generateLegalMoves(&root, moves);
+
+    std::vector<uint64_t> counts(moves.size(), 0);
+
+    // Under depth 3 the subtrees are too small to be worth a thread
+    if (depth < 3 || threads <= 1)
+    {
+        HashStats stats;
+
+        for (int i = 0; i < (int)moves.size(); i++)
+        {
+            root.makeMove(moves[i]);
+            counts[i] = subtreeCount(root, depth - 1, table, stats);
+            root.unmakeMove(moves[i]);
+        }
+
+        if (table)
+            table->addStats(stats.probes, stats.hits);
+    }
+    else
+    {
+        std::vector<Task> tasks;
+
+        for (int i = 0; i < (int)moves.size(); i++)
+        {
+            MoveList replies;
+            root.makeMove(moves[i]);
+            MoveGen::generateLegalMoves(&root, replies);
+            root.unmakeMove(moves[i]);
+
+            for (const Move &reply : replies)
+                tasks.push_back({i, moves[i], reply});
+        }
+
+        threads = std::max(1, std::min(threads, (int)tasks.size()));
+
+        std::unique_ptr<Batch[]> batches(new Batch[threads]);
+        for (int t = 0; t < threads; t++)
+        {
+            batches[t].next = tasks.size() * t / threads;
+            batches[t].end = tasks.size() * (t + 1) / threads;
+        }
+
+        std::vector<std::vector<uint64_t>> threadCounts(threads, std::vector<uint64_t>(moves.size(), 0));
+        std::vector<std::thread> pool;
+
+        for (int t = 0; t < threads; t++)
+        {
+            pool.emplace_back([&, t]
+            {
+                Board position = root;
+                position.undoStack.reserve(MaxPly);
+                HashStats stats;
+
+                // Own batch first, then the others' in turn
+                for (int i = 0; i < threads; i++)
+                {
+                    Batch &batch = batches[(t + i) % threads];
+
+                    for (size_t n = batch.next++; n < batch.end; n = batch.next++)
+                    {
+                        const Task &task = tasks[n];
+
+                        position.makeMove(task.root);
+                        position.makeMove(task.reply);
+                        threadCounts[t][task.rootIndex] += subtreeCount(position, depth - 2, table, stats);
+                        position.unmakeMove(task.reply);
+                        position.unmakeMove(task.root);
+                    }
+                }
+
+                if (table)
+                    table->addStats(stats.probes, stats.hits);
+            });
+        }
+
+        for (std::thread &thread : pool)
+            thread.join();
+
+        for (const std::vector<uint64_t> &threadCount : threadCounts)
+        {
+            for (size_t i = 0; i < counts.size(); i++)
+                counts[i] += threadCount[i];
+        }
+    }
+
+    uint64_t total = 0;
+    for (uint64_t count : counts)
+        total += count;
+
+    if (moveCounts)
+        *moveCounts = std::move(counts);
+
+    return total;
+}
+
+uint64_t Perft::divide(Board &board, int depth, int threads, PerftTable *table)
+{
+    Stopwatch sw;
+    sw.start();
+
+    MoveList moves;
+    MoveGen::generateLegalMoves(&board, moves);
+
+    std::vector<uint64_t> counts;
+    const uint64_t total = parallelPerft(board, depth, threads, &counts, table);
+
+    sw.stop();
+
+    for (int i = 0; i < (int)moves.size(); i++)
+        std::cout << board.moveToUci(moves[i]) << ": " << counts[i] << std::endl;
+
+    const long long ms = std::max(sw.getElapsedTimeMilliseconds(), 1LL);
+
+    std::cout << std::endl;
+    std::cout << "Nodes searched: " << total << std::endl;
+    std::cout << "Threads       : " << threads << std::endl;
+    std::cout << "Time (ms)     : " << ms << std::endl;
+    std::cout << "Nodes/second  : " << total * 1000 / ms << std::endl;
+
+    if (table)
+        std::cout << "Hash hit rate : " << table->hitRate() * 100 << "% of " << table->probes() << " probes ("
+                  << table->sizeMB() << " MB)" << std::endl;
+
+    return total;
+}
+
+void Perft::threadScaling(const Board &board, int depth, int maxThreads)
+{
+    Stopwatch sw;
+    long long baseMs = 0;
+
+    for (int threads = 1; threads <= std::max(maxThreads, 1); threads *= 2)
+    {
+        sw.start();
+        const uint64_t nodes = parallelPerft(board, depth, threads);
+        sw.stop();
+
+        const long long ms = std::max(sw.getElapsedTimeMilliseconds(), 1LL);
+
+        if (threads == 1)
+            baseMs = ms;
+
+        std::cout << "Threads " << threads << ": perft " << depth << " = " << nodes << " nodes in " << ms
+                  << "ms, " << nodes * 1000 / ms << " nodes/sec, speedup " << double(baseMs) / ms << "x"
+                  << std::endl;
+    }
+}
+
+void Perft::hashComparison(const Board &board, int depth, int threads, size_t hashMB)
+{
+    PerftTable table(hashMB);
+    Stopwatch sw;
+
+    sw.start();
+    const uint64_t plainNodes = parallelPerft(board, depth, threads);
+    sw.stop();
+    const long long plainMs = std::max(sw.getElapsedTimeMilliseconds(), 1LL);
+
+    sw.start();
+    const uint64_t hashedNodes = parallelPerft(board, depth, threads, nullptr, &table);
+    sw.stop();
+    const long long hashedMs = std::max(sw.getElapsedTimeMilliseconds(), 1LL);
+
+    std::cout << "Unhashed: perft " << depth << " = " << plainNodes << " nodes in " << plainMs << "ms" << std::endl;
+    std::cout << "Hashed  : perft " << depth << " = " << hashedNodes << " nodes in " << hashedMs << "ms, "
+              << table.hitRate() * 100 << "% hit rate, speedup " << double(plainMs) / hashedMs << "x ("
+              << table.sizeMB() << " MB)" << std::endl;
+
+    if (plainNodes != hashedNodes)
+        std::cout << "MISMATCH: hashed count differs" << std::endl;
+}
+
+bool Perft::run(int depth, const std::string &fen, int threads, size_t hashMB)
+{
+    Board board;
+
+    if (!board.loadFen(fen.empty() ? StartFen : fen))
+    {
+        std::cout << "Invalid FEN: " << fen << std::endl;
+        return false;
+    }
+
+    if (hashMB)
+    {
+        PerftTable table(hashMB);
+        divide(board, std::max(depth, 1), threads, &table);
+    }
+    else
+    {
+        divide(board, std::max(depth, 1), threads);
+    }
+
+    return true;
+}
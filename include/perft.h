@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+// Subtree node counts keyed by position and remaining depth. Like the search's table it is shared
+// between threads without locks, each entry's key XORed with its data so a torn write fails the check
+class PerftTable
+{
+public:
+    static constexpr size_t DefaultSizeMB = 64;
+
+    explicit PerftTable(size_t megabytes = DefaultSizeMB) { resize(megabytes); }
+
+    // Reallocates and clears the table, and its statistics
+    void resize(size_t megabytes);
+    void clear();
+
+    bool probe(uint64_t key, int depth, uint64_t &nodes) const;
+    void store(uint64_t key, int depth, uint64_t nodes);
+
+    // Added by each perft call (or thread) when it finishes, not on every probe
+    void addStats(uint64_t probeCount, uint64_t hitCount);
+    uint64_t probes() const { return probeCount.load(std::memory_order_relaxed); }
+    uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+    double hitRate() const { return probes() ? double(hits()) / probes() : 0.0; }
+
+    size_t sizeMB() const { return bucketCount * sizeof(Bucket) / (1024 * 1024); }
+
+private:
+    // Node count in the low 56 bits, depth in the top 8
+    struct Entry
+    {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    // The first slot keeps the deeper of the two subtrees, the second always takes the newest
+    struct alignas(32) Bucket
+    {
+        Entry deep;
+        Entry recent;
+    };
+
+    Bucket *bucketFor(uint64_t key) const
+    {
+        return &buckets[(unsigned __int128)key * bucketCount >> 64];
+    }
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount = 0;
+    std::atomic<uint64_t> probeCount{0};
+    std::atomic<uint64_t> hitCount{0};
+};
+
+// Counts leaf nodes of the legal move tree, to check move generation against known totals
+// and to measure its speed
+namespace Perft
+{
+    // Bulk counting: at depth 1 the legal move count is the answer, so leaf moves are never made
+    uint64_t perft(Board &board, int depth);
+
+    // Same count, looking up and storing subtrees in table (depth 2 and up, below that a probe
+    // costs more than the count)
+    uint64_t perft(Board &board, int depth, PerftTable &table);
+
+    // Same count spread over threads, each with its own board copy. The work is every depth 2
+    // subtree (a root move and a reply), handed out in per thread batches, and a thread that runs
+    // out steals from the others. moveCounts, if given, gets one count per root legal move in
+    // generation order. All threads share table if one is given
+    uint64_t parallelPerft(const Board &board, int depth, int threads, std::vector<uint64_t> *moveCounts = nullptr,
+                           PerftTable *table = nullptr);
+
+    // Per root move counts and the total, with time and nodes/second (and hash hit rate).
+    // Returns the total
+    uint64_t divide(Board &board, int depth, int threads = 1, PerftTable *table = nullptr);
+
+    // Times the same count at 1, 2, 4... up to maxThreads threads and prints the speedup
+    void threadScaling(const Board &board, int depth, int maxThreads);
+
+    // Times the count without and with a freshly cleared table of hashMB, and prints the
+    // hit rate and speedup
+    void hashComparison(const Board &board, int depth, int threads, size_t hashMB);
+
+    // Runs divide on fen, or the start position if it's empty, hashed if hashMB isn't 0.
+    // Returns false on a bad FEN
+    bool run(int depth, const std::string &fen = "", int threads = 1, size_t hashMB = 0);
+};
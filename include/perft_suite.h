@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "perft.h"
+#include "Stopwatch.h"
+
+// Checks move generation against an EPD file of known perft counts, one position per line:
+//   <fen> ;D1 20 ;D2 400 ;D3 8902
+// Every (position, depth) pair is a separate job, and jobs run in parallel on a shared counter
+class PerftSuite
+{
+public:
+    struct Position
+    {
+        std::string fen;
+        std::vector<std::pair<int, uint64_t>> expected; // (depth, nodes)
+    };
+
+    // Returns false if the file can't be read or a line doesn't parse
+    bool load(const std::string &path)
+    {
+        std::ifstream file(path);
+
+        if (!file)
+        {
+            std::cout << "Can't open " << path << std::endl;
+            return false;
+        }
+
+        positions.clear();
+
+        std::string line;
+        int lineNumber = 0;
+
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            Position position;
+            std::istringstream fields(line);
+            std::string field;
+
+            std::getline(fields, position.fen, ';');
+            position.fen.erase(position.fen.find_last_not_of(" \t\r") + 1);
+
+            while (std::getline(fields, field, ';'))
+            {
+                std::istringstream annotation(field);
+                std::string tag;
+                uint64_t nodes;
+
+                if (!(annotation >> tag >> nodes) || tag.size() < 2 || tag[0] != 'D')
+                {
+                    std::cout << path << ":" << lineNumber << ": bad annotation \"" << field << "\"" << std::endl;
+                    return false;
+                }
+
+                position.expected.push_back({std::atoi(tag.c_str() + 1), nodes});
+            }
+
+            Board board;
+            if (!board.loadFen(position.fen))
+            {
+                std::cout << path << ":" << lineNumber << ": bad FEN" << std::endl;
+                return false;
+            }
+
+            positions.push_back(position);
+        }
+
+        return true;
+    }
+
+    // Runs every depth up to maxDepth (0 for all of them). Returns true if every count matched
+    bool run(int threads, int maxDepth = 0)
+    {
+        struct Job
+        {
+            int position;
+            int depth;
+            uint64_t expected;
+            uint64_t nodes = 0;
+            long long ms = 0;
+        };
+
+        std::vector<Job> jobs;
+
+        for (int i = 0; i < (int)positions.size(); i++)
+        {
+            for (auto [depth, nodes] : positions[i].expected)
+            {
+                if (maxDepth <= 0 || depth <= maxDepth)
+                    jobs.push_back({i, depth, nodes});
+            }
+        }
+
+        // Biggest first, so no thread is left with a long job at the end
+        std::vector<int> order(jobs.size());
+        for (int i = 0; i < (int)order.size(); i++)
+            order[i] = i;
+
+        std::sort(order.begin(), order.end(), [&jobs](int a, int b) { return jobs[a].expected > jobs[b].expected; });
+
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> pool;
+        Stopwatch sw;
+
+        sw.start();
+
+        for (int t = 0; t < std::max(threads, 1); t++)
+        {
+            pool.emplace_back([&]
+            {
+                for (size_t n = next++; n < order.size(); n = next++)
+                {
+                    Job &job = jobs[order[n]];
+
+                    Board board;
+                    board.loadFen(positions[job.position].fen);
+
+                    Stopwatch jobTime;
+                    jobTime.start();
+                    job.nodes = Perft::perft(board, job.depth);
+                    jobTime.stop();
+
+                    job.ms = jobTime.getElapsedTimeMilliseconds();
+                }
+            });
+        }
+
+        for (std::thread &thread : pool)
+            thread.join();
+
+        sw.stop();
+
+        // Report in file order
+        std::vector<long long> positionMs(positions.size(), 0);
+        std::vector<uint64_t> positionNodes(positions.size(), 0);
+        std::vector<int> positionDepth(positions.size(), 0);
+        std::vector<std::string> failures(positions.size());
+        uint64_t totalNodes = 0;
+        int mismatches = 0;
+
+        for (const Job &job : jobs)
+        {
+            positionMs[job.position] += job.ms;
+            positionNodes[job.position] += job.nodes;
+            positionDepth[job.position] = std::max(positionDepth[job.position], job.depth);
+            totalNodes += job.nodes;
+
+            if (job.nodes != job.expected)
+            {
+                mismatches++;
+                failures[job.position] += "    D" + std::to_string(job.depth) + ": expected " +
+                                          std::to_string(job.expected) + ", got " + std::to_string(job.nodes) + "\n";
+            }
+        }
+
+        for (int i = 0; i < (int)positions.size(); i++)
+        {
+            std::cout << "Position " << std::setw(2) << i + 1 << "/" << positions.size() << ": "
+                      << (failures[i].empty() ? "OK  " : "FAIL") << " depth " << positionDepth[i] << " "
+                      << std::setw(10) << positionNodes[i] << " nodes " << std::setw(6) << positionMs[i] << "ms  "
+                      << positions[i].fen << std::endl;
+
+            std::cout << failures[i];
+        }
+
+        const long long ms = std::max(sw.getElapsedTimeMilliseconds(), 1LL);
+
+        std::cout << "==========================" << std::endl;
+        std::cout << "Positions      : " << positions.size() << std::endl;
+        std::cout << "Counts checked : " << jobs.size() << std::endl;
+        std::cout << "Mismatches     : " << mismatches << std::endl;
+        std::cout << "Threads        : " << std::max(threads, 1) << std::endl;
+        std::cout << "Total time (ms): " << ms << std::endl;
+        std::cout << "Nodes          : " << totalNodes << std::endl;
+        std::cout << "Nodes/second   : " << totalNodes * 1000 / ms << std::endl;
+
+        return mismatches == 0;
+    }
+
+private:
+    std::vector<Position> positions;
+};
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <stdint.h>
-#include <vector>
+#include <array>
+#include <cctype>
 
 enum PieceType
 {
@@ -19,20 +20,17 @@ class Piece
 public:
     PieceType type;
     bool isWhite;
-    bool hasMoved;
 
     Piece()
     {
         type = None;
         isWhite = true;
-        hasMoved = false;
     }
 
     Piece(const PieceType _type, bool white)
     {
         type = _type;
         isWhite = white;
-        hasMoved = false;
     }
 };
 
@@ -88,9 +86,9 @@ namespace PieceData
     }
 };
 
-inline std::vector<Piece> loadFenString(const char *fen)
+inline std::array<Piece, 64> loadFenString(const char *fen)
 {
-    std::vector<Piece> pieces(64);
+    std::array<Piece, 64> pieces{};
 
     int rank = 7;
     int file = 0;
@@ -16,7 +16,7 @@
 #include "window.h"
 #include "piece.h"
 #include "move_generator.h"
-#include "board.h"
+#include "board_view.h"
 
 class Renderer
 {
@@ -70,7 +70,7 @@ public:
         glClear(GL_COLOR_BUFFER_BIT);
     }
 
-    void drawPiece(Board *board, Window &window, const Piece &piece, glm::vec2 pos, int i)
+    void drawPiece(BoardView *view, Window &window, const Piece &piece, glm::vec2 pos, int i)
     {
         if (piece.type == None)
             return;
@@ -83,7 +83,7 @@ public:
 
         pieceShader->setVec2("scale", glm::vec2(sx, sy));
 
-        if(!board->isDragging || board->selectedSquare != i)
+        if(!view->isDragging || view->selectedSquare != i)
         {
             float ox = -1.0f + (window.screenWidth - smallestDimension) / window.screenWidth - sx + (sx * pos.x) * 2.0f;
             float oy = -1.0f + (window.screenHeight - smallestDimension) / window.screenHeight - sy + (sy * pos.y) * 2.0f;
@@ -98,7 +98,7 @@ public:
         }
         
 
-        if (board->isDragging && board->selectedSquare == i)
+        if (view->isDragging && view->selectedSquare == i)
         {
             glm::vec2 mousePos = window.getMousePosition();
 
@@ -117,7 +117,7 @@ public:
         }
     }
 
-    void render(Window window, const Board &board)
+    void render(Window window, const BoardView &view)
     {
         shader->use();
 
@@ -129,15 +129,15 @@ public:
 
         shader->setVec3("selectedColour", glm::vec3(0.813, 0.458, 0.187));
 
-        shader->setInt("selectedSquare", board.selectedSquare);
+        shader->setInt("selectedSquare", view.selectedSquare);
 
         std::vector<int> legalMovesForPiece;
 
-        for(auto& move : board.legalMoves)
+        for(auto& move : view.legalMoves)
         {
-            if(move.from == board.selectedSquare)
+            if(move.from() == view.selectedSquare)
             {
-                legalMovesForPiece.push_back(move.to);
+                legalMovesForPiece.push_back(move.to());
             }
         }
         
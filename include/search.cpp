@@ -0,0 +1,697 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+#include "search.h"
+
+// Late move reductions in plies, by remaining depth and move number. Both grow with the log,
+// so the latest moves at the highest depths are cut the most. Filled once at startup
+static const auto reductions = []
+{
+    std::array<std::array<int, 64>, MaxSearchDepth + 1> table{};
+
+    for (int depth = 1; depth <= MaxSearchDepth; depth++)
+        for (int moveNumber = 1; moveNumber < 64; moveNumber++)
+            table[depth][moveNumber] = int(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+
+    return table;
+}();
+
+void Search::setThreads(int count)
+{
+    wait();
+
+    workers.clear();
+    for (int id = 0; id < std::max(count, 1); id++)
+        workers.push_back(std::make_unique<SearchWorker>(*this, id));
+}
+
+Move Search::go(const Board &board, const SearchLimits &searchLimits)
+{
+    start(board, searchLimits);
+    wait();
+
+    return bestWorker().bestMove;
+}
+
+void Search::start(const Board &board, const SearchLimits &searchLimits)
+{
+    wait();
+
+    limits = searchLimits;
+    pondering = limits.ponder;
+    timeManager.start(pondering || limits.infinite ? 0 : limits.moveTimeMs, limits.fixedTime);
+    stopFlag.store(false, std::memory_order_relaxed);
+    ponderhitFlag.store(false, std::memory_order_relaxed);
+
+    TT.newSearch();
+
+    for (auto &worker : workers)
+    {
+        worker->board = board;
+        worker->board.undoStack.reserve(1024);
+        worker->nodes.store(0, std::memory_order_relaxed);
+        worker->completedDepth = 0;
+        worker->bestMove = Move::none();
+        worker->bestValue = -InfinityScore;
+        worker->bestPv.clear();
+        worker->selDepth = 0;
+        worker->cutoffs = 0;
+        worker->firstMoveCutoffs = 0;
+    }
+
+    for (auto &worker : workers)
+        threads.emplace_back([&worker] { worker->iterativeDeepening(); });
+}
+
+void Search::wait()
+{
+    for (std::thread &thread : threads)
+        thread.join();
+
+    threads.clear();
+}
+
+const SearchWorker &Search::bestWorker() const
+{
+    const SearchWorker *best = workers[0].get();
+
+    for (auto &worker : workers)
+    {
+        if (worker->completedDepth > best->completedDepth && worker->bestMove != Move::none())
+            best = worker.get();
+    }
+
+    return *best;
+}
+
+uint64_t Search::nodes() const
+{
+    uint64_t total = 0;
+
+    for (auto &worker : workers)
+        total += worker->nodes.load(std::memory_order_relaxed);
+
+    return total;
+}
+
+void SearchWorker::iterativeDeepening()
+{
+    MoveList moves;
+    MoveGen::generateLegalMoves(&board, moves);
+
+    if (moves.empty())
+        return;
+
+    const bool isMain = id == 0;
+    const SearchLimits &limits = owner.limits;
+
+    TTData ttData;
+    bestMove = TT.probe(board.key, ttData) ? ttData.move : Move::none();
+    int stableIterations = 0;
+    nullMoveMinPly = 0;
+
+    clearHistory();
+
+    // Nothing to think about with a single legal move, unless told to keep going
+    const bool untilStopped = limits.infinite || limits.ponder;
+    const int maxDepth = moves.size() == 1 && !untilStopped ? 1 : std::min(limits.depth, MaxSearchDepth);
+
+    // Odd helpers start one iteration ahead, so threads spread over neighbouring depths
+    // instead of all racing through the same tree
+    for (int depth = 1 + (id & 1); depth <= maxDepth; depth++)
+    {
+        const Move previousBest = bestMove;
+
+        // Aspiration window: expect a score close to the last one, and widen whichever side
+        // it falls outside of, by more each time, until it lands inside
+        int delta = AspirationDelta;
+        int alpha = -InfinityScore;
+        int beta = InfinityScore;
+
+        if (depth >= AspirationMinDepth && std::abs(bestValue) < MateThreshold)
+        {
+            alpha = bestValue - delta;
+            beta = bestValue + delta;
+        }
+
+        int value;
+        Move move;
+
+        while (true)
+        {
+            move = searchRoot(moves, depth, bestMove, alpha, beta, value);
+
+            // Any move that raised alpha, even in an aborted or failed search, scored better
+            // than the best move did in the same window, since that was searched first
+            if (move != Move::none() && move != bestMove)
+            {
+                bestMove = move;
+                bestPv.assign(pv[0], pv[0] + pvLength[0]);
+            }
+
+            if (owner.stopped())
+                break;
+
+            if (value <= alpha)
+                alpha = std::max(alpha - delta, -InfinityScore);
+            else if (value >= beta)
+                beta = std::min(beta + delta, InfinityScore);
+            else
+                break;
+
+            delta += delta / 2;
+        }
+
+        if (owner.stopped())
+            break;
+
+        stableIterations = move == previousBest ? stableIterations + 1 : 0;
+        bestMove = move;
+        bestValue = value;
+        bestPv.assign(pv[0], pv[0] + pvLength[0]);
+        completedDepth = depth;
+
+        TT.store(board.key, bestMove, scoreToTT(bestValue, 0), depth, BoundExact);
+
+        if (!isMain)
+            continue;
+
+        if (owner.onIteration)
+            owner.onIteration({depth, selDepth, bestValue, bestMove, bestPv, owner.nodes(),
+                               owner.timeManager.elapsedMs(), TT.hashfull()});
+
+        checkPonderhit();
+
+        if (owner.pondering || limits.infinite)
+            continue;
+
+        // A forced mate won't get any shorter by searching deeper
+        if (std::abs(bestValue) >= MateThreshold || owner.timeManager.softLimitReached(stableIterations))
+            break;
+    }
+
+    // Only possible if the clock ran out before the first move at depth 1 finished
+    if (bestMove == Move::none())
+        bestMove = moves[0];
+
+    if (!isMain)
+        return;
+
+    // The best move mustn't be reported early in infinite or ponder mode, so hold on
+    // to it until the GUI says stop (or ponderhit, which ends a finished ponder search)
+    while (!owner.stopped() && (limits.infinite || owner.pondering))
+    {
+        checkPonderhit();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Helpers keep going until the main thread is done
+    owner.stop();
+}
+
+// Once the opponent plays the expected move, pondering turns into a normal search
+// with the clock starting now
+void SearchWorker::checkPonderhit()
+{
+    if (owner.pondering && owner.ponderhitFlag.load(std::memory_order_relaxed))
+    {
+        owner.pondering = false;
+        owner.timeManager.start(owner.limits.moveTimeMs, owner.limits.fixedTime);
+    }
+}
+
+Move SearchWorker::searchRoot(MoveList &moves, int depth, Move previousBest, int alpha, int beta, int &value)
+{
+    Move best = Move::none();
+
+    pvLength[0] = 0;
+
+    orderMoves(moves, previousBest, 0);
+
+    for (int i = 0; i < (int)moves.size(); i++)
+    {
+        const Move move = moves[i];
+
+        pushStack(0, move);
+        board.makeMove(move);
+        int val = i == 0 ? -search(depth - 1, -beta, -alpha, 1) : pvsSearch(depth - 1, alpha, beta, 1);
+        board.unmakeMove(move);
+
+        if (owner.stopped())
+            break;
+
+        if (val > alpha)
+        {
+            alpha = val;
+            best = move;
+            updatePv(0, move);
+
+            if (val >= beta)
+                break;
+        }
+    }
+
+    value = alpha;
+    return best;
+}
+
+// Principal variation search for a move after the first: a null window only asks whether it
+// beats alpha, which is cheaper to answer than by how much. A reduced move that beats alpha is
+// searched again at full depth, and re-searched with the full window only when it still does
+// and the window is wider than null. Called with the move already made
+int SearchWorker::pvsSearch(int depth, int alpha, int beta, int ply, int reduction)
+{
+    int eval = -search(depth - reduction, -alpha - 1, -alpha, ply);
+
+    if (reduction > 0 && eval > alpha && !owner.stopped())
+        eval = -search(depth, -alpha - 1, -alpha, ply);
+
+    if (eval > alpha && eval < beta && !owner.stopped())
+        eval = -search(depth, -beta, -alpha, ply);
+
+    return eval;
+}
+
+void SearchWorker::updatePv(int ply, Move move)
+{
+    pv[ply][ply] = move;
+
+    for (int i = ply + 1; i < pvLength[ply + 1]; i++)
+        pv[ply][i] = pv[ply + 1][i];
+
+    pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+}
+
+// Only the main thread checks the limits, and only reads the clock every 1024 nodes, so the
+// hard limit is overshot by well under a millisecond. Everyone else just watches the stop flag
+bool SearchWorker::checkAbort()
+{
+    const uint64_t count = nodes.load(std::memory_order_relaxed) + 1;
+    nodes.store(count, std::memory_order_relaxed);
+
+    if (id != 0 || owner.pondering)
+    {
+        if (id == 0 && (count & 1023) == 0)
+            checkPonderhit();
+
+        return owner.stopped();
+    }
+
+    if (owner.limits.nodes && owner.nodes() >= owner.limits.nodes)
+        owner.stop();
+
+    if ((count & 1023) == 0 && owner.timeManager.hardLimitReached())
+        owner.stop();
+
+    return owner.stopped();
+}
+
+int SearchWorker::searchAllCaptures(int alpha, int beta, int ply)
+{
+    if (checkAbort())
+        return 0;
+
+    selDepth = std::max(selDepth, ply);
+
+    int eval = board.evaluate();
+
+    if (eval >= beta)
+        return beta;
+
+    alpha = std::max(alpha, eval);
+
+    MoveList captureMoves;
+    MoveGen::generateLegalMoves(&board, captureMoves, true);
+    orderMoves(captureMoves, Move::none(), ply);
+
+    for (auto &move : captureMoves)
+    {
+        board.makeMove(move);
+        eval = -searchAllCaptures(-beta, -alpha, ply + 1);
+        board.unmakeMove(move);
+
+        if (owner.stopped())
+            return 0;
+
+        if (eval >= beta)
+            return beta;
+
+        alpha = std::max(alpha, eval);
+    }
+
+    return alpha;
+}
+
+int SearchWorker::search(int depth, int alpha, int beta, int ply)
+{
+    pvLength[ply] = ply;
+
+    if (depth == 0)
+        return searchAllCaptures(alpha, beta, ply);
+
+    if (checkAbort())
+        return 0;
+
+    selDepth = std::max(selDepth, ply);
+
+    const int originalAlpha = alpha;
+
+    TTData ttData;
+    Move ttMove = Move::none();
+
+    if (TT.probe(board.key, ttData))
+    {
+        ttMove = ttData.move;
+
+        if (ttData.depth >= depth)
+        {
+            int ttScore = scoreFromTT(ttData.score, ply);
+
+            if (ttData.bound == BoundExact)
+                return std::clamp(ttScore, alpha, beta);
+            if (ttData.bound == BoundLower && ttScore >= beta)
+                return beta;
+            if (ttData.bound == BoundUpper && ttScore <= alpha)
+                return alpha;
+        }
+    }
+
+    const bool pvNode = beta - alpha > 1;
+    const bool inCheck = board.inCheck();
+
+    if (!pvNode && !inCheck && nullMovePrunes(depth, beta, ply))
+        return beta;
+
+    MoveList moves;
+    MoveGen::generateLegalMoves(&board, moves);
+
+    if (moves.empty())
+    {
+        // Checkmate detected
+        if (inCheck)
+        {
+            return -MateScore + ply;
+        }
+        // Stalemate
+        return 0;
+    }
+
+    orderMoves(moves, ttMove, ply);
+
+    Move bestMove = Move::none();
+    MoveList quietsTried;
+    MoveList capturesTried;
+
+    for (int i = 0; i < (int)moves.size(); i++)
+    {
+        const Move move = moves[i];
+
+        const bool capture = capturedType(move) != None;
+        const bool quiet = !capture && !move.isPromotion();
+
+        pushStack(ply, move);
+        board.makeMove(move);
+
+        int eval;
+
+        if (i == 0)
+        {
+            eval = -search(depth - 1, -beta, -alpha, ply + 1);
+        }
+        else
+        {
+            // Late quiet moves are rarely best, given decent ordering, so they get a shallower
+            // search first. Less so on the PV, and when in or giving check
+            int reduction = 0;
+
+            if (quiet && depth >= LmrMinDepth && i >= LmrMinMoves)
+            {
+                reduction = reductions[std::min(depth, MaxSearchDepth)][std::min(i, 63)];
+
+                if (pvNode)
+                    reduction--;
+
+                if (inCheck || board.inCheck())
+                    reduction--;
+
+                reduction -= history[board.isWhiteTurn ? Black : White][move.from()][move.to()] / HistoryLmrDivisor;
+
+                reduction = std::clamp(reduction, 0, depth - 2);
+            }
+
+            eval = pvsSearch(depth - 1, alpha, beta, ply + 1, reduction);
+        }
+
+        board.unmakeMove(move);
+
+        // Scores from an aborted search are meaningless, and mustn't reach the TT
+        if (owner.stopped())
+            return 0;
+
+        if (eval >= beta)
+        {
+            cutoffs++;
+            firstMoveCutoffs += i == 0;
+            updateCutoffStats(move, quietsTried, capturesTried, depth, ply);
+
+            TT.store(board.key, move, scoreToTT(beta, ply), depth, BoundLower);
+            return beta;
+        }
+
+        if (eval > alpha)
+        {
+            alpha = eval;
+            bestMove = move;
+            updatePv(ply, move);
+        }
+
+        if (quiet)
+            quietsTried.push_back(move);
+        else if (capture)
+            capturesTried.push_back(move);
+    }
+
+    TT.store(board.key, bestMove, scoreToTT(alpha, ply), depth, alpha > originalAlpha ? BoundExact : BoundUpper);
+
+    return alpha;
+}
+
+// If giving the opponent a free move still leaves us at or above beta, a real move would almost
+// certainly do too. Wrong in zugzwang, where every real move is worse than passing, so it's never
+// tried without pieces, and verified where zugzwang is plausible
+bool SearchWorker::nullMovePrunes(int depth, int beta, int ply)
+{
+    if (depth < NullMoveMinDepth || ply < nullMoveMinPly || stack[ply - 1].move == Move::none())
+        return false;
+
+    const Bitboard pieces = board.nonPawnPieces(board.isWhiteTurn);
+
+    if (!pieces || std::abs(beta) >= MateThreshold)
+        return false;
+
+    const int staticEval = board.evaluate();
+
+    if (staticEval < beta)
+        return false;
+
+    // Reduce more at higher depth, and the further the position already is above beta
+    const int R = 3 + depth / 4 + std::min((staticEval - beta) / 200, 3);
+    const int nullDepth = std::max(depth - 1 - R, 0);
+
+    pushStack(ply, Move::none());
+    board.makeNullMove();
+    int nullScore = -search(nullDepth, -beta, -beta + 1, ply + 1);
+    board.unmakeNullMove();
+
+    if (owner.stopped() || nullScore < beta)
+        return false;
+
+    const bool zugzwangRisk = Bitboards::popCount(pieces) == 1 && !(pieces & board.pieceBitboards[Queen]);
+
+    if (depth < NullMoveVerifyDepth && !zugzwangRisk)
+        return true;
+
+    // Verify with the same reduced depth, null moves off for the first plies of it
+    const int savedMinPly = nullMoveMinPly;
+    nullMoveMinPly = ply + 3 * nullDepth / 4 + 1;
+    const int verifyScore = search(nullDepth, beta - 1, beta, ply);
+    nullMoveMinPly = savedMinPly;
+
+    return !owner.stopped() && verifyScore >= beta;
+}
+
+void SearchWorker::orderMoves(MoveList &moves, Move ttMove, int ply)
+{
+    // Bands: TT move, then captures and promotions, then killers, then history (within
+    // +-2 * HistoryMax, well below KillerScore - 1)
+    constexpr int TTMoveScore = 1000000;
+    constexpr int CaptureScore = 500000;
+    constexpr int KillerScore = 400000;
+    static_assert(KillerScore - 1 > 2 * HistoryMax, "history must stay below the killers");
+
+    int scores[MoveList::Capacity];
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        const Move move = moves[i];
+        int &score = scores[i];
+
+        PieceType moveType = board.pieces[move.from()].type;
+        PieceType captureType = board.pieces[move.to()].type;
+
+        if (move == ttMove)
+        {
+            score = TTMoveScore;
+        }
+        else if (move.isEnPassant())
+        {
+            score = CaptureScore + 10 * PieceData::PawnValue - PieceData::PawnValue +
+                    captureHistory[pieceIndex(board.pieces[move.from()])][move.to()][Pawn] / 16;
+        }
+        else if (captureType != None)
+        {
+            // MVV-LVA first, capture history to break ties between similar captures
+            score = CaptureScore + 10 * board.getPieceValue(captureType) - board.getPieceValue(moveType) +
+                    captureHistory[pieceIndex(board.pieces[move.from()])][move.to()][captureType] / 16;
+        }
+        else if (move.isPromotion())
+        {
+            score = CaptureScore;
+        }
+        else if (move == killers[ply][0])
+        {
+            score = KillerScore;
+        }
+        else if (move == killers[ply][1])
+        {
+            score = KillerScore - 1;
+        }
+        else
+        {
+            score = quietHistory(move, ply);
+        }
+
+        if (move.isPromotion() && move != ttMove)
+        {
+            score += board.getPieceValue(move.promotionPiece());
+        }
+    }
+
+    // Insertion sort, best first, on scores worked out once per move
+    for (int i = 1; i < moves.size(); i++)
+    {
+        const Move move = moves[i];
+        const int score = scores[i];
+        int j = i - 1;
+
+        for (; j >= 0 && scores[j] < score; j--)
+        {
+            moves[j + 1] = moves[j];
+            scores[j + 1] = scores[j];
+        }
+
+        moves[j + 1] = move;
+        scores[j + 1] = score;
+    }
+}
+
+void SearchWorker::pushStack(int ply, Move move)
+{
+    stack[ply].move = move;
+    stack[ply].continuation = move == Move::none()
+                                  ? &emptyContinuation
+                                  : &continuationHistory[pieceIndex(board.pieces[move.from()])][move.to()];
+}
+
+int SearchWorker::quietHistory(Move move, int ply) const
+{
+    const int piece = pieceIndex(board.pieces[move.from()]);
+
+    // Each continuation entry sees far fewer updates than a butterfly one, so counts for half.
+    // Clamped so a quiet move never reaches the killer band in orderMoves
+    const int score = history[board.isWhiteTurn ? White : Black][move.from()][move.to()] +
+                      ((*stack[ply - 1].continuation)[piece][move.to()] +
+                       (*stack[ply - 2].continuation)[piece][move.to()]) / 2;
+
+    return std::clamp(score, -2 * HistoryMax, 2 * HistoryMax);
+}
+
+void SearchWorker::clearHistory()
+{
+    std::fill(&killers[0][0], &killers[0][0] + sizeof(killers) / sizeof(Move), Move::none());
+    std::fill(&history[0][0][0], &history[0][0][0] + sizeof(history) / sizeof(int), 0);
+    std::fill(&continuationHistory[0][0][0][0], &continuationHistory[0][0][0][0] + sizeof(continuationHistory) / sizeof(int), 0);
+    std::fill(&emptyContinuation[0][0], &emptyContinuation[0][0] + sizeof(emptyContinuation) / sizeof(int), 0);
+    std::fill(&captureHistory[0][0][0], &captureHistory[0][0][0] + sizeof(captureHistory) / sizeof(int), 0);
+
+    for (int ply : {-2, -1})
+        pushStack(ply, Move::none());
+}
+
+void SearchWorker::updateCutoffStats(Move move, const MoveList &quietsTried, const MoveList &capturesTried, int depth, int ply)
+{
+    const int us = board.isWhiteTurn ? White : Black;
+    const int bonus = std::min(32 * depth * depth, HistoryMax / 8);
+
+    auto updateQuiet = [&](Move quiet, int amount)
+    {
+        const int piece = pieceIndex(board.pieces[quiet.from()]);
+
+        updateHistory(history[us][quiet.from()][quiet.to()], amount);
+
+        // Not after a null move, whose continuation entry must stay empty
+        for (int back : {1, 2})
+        {
+            if (stack[ply - back].move != Move::none())
+                updateHistory((*stack[ply - back].continuation)[piece][quiet.to()], amount);
+        }
+    };
+
+    auto updateCapture = [&](Move capture, int amount)
+    {
+        updateHistory(captureHistory[pieceIndex(board.pieces[capture.from()])][capture.to()][capturedType(capture)], amount);
+    };
+
+    if (capturedType(move) != None)
+    {
+        updateCapture(move, bonus);
+    }
+    else if (!move.isPromotion())
+    {
+        // Sibling positions tend to be refuted by the same quiet move
+        if (killers[ply][0] != move)
+        {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = move;
+        }
+
+        updateQuiet(move, bonus);
+
+        for (const Move &tried : quietsTried)
+            updateQuiet(tried, -bonus);
+    }
+
+    // Captures are tried first, so they all missed the cutoff whatever kind of move took it
+    for (const Move &tried : capturesTried)
+        updateCapture(tried, -bonus);
+}
+
+int SearchWorker::scoreToTT(int score, int ply)
+{
+    if (score >= MateThreshold)
+        return score + ply;
+    if (score <= -MateThreshold)
+        return score - ply;
+    return score;
+}
+
+int SearchWorker::scoreFromTT(int score, int ply)
+{
+    if (score >= MateThreshold)
+        return score - ply;
+    if (score <= -MateThreshold)
+        return score + ply;
+    return score;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "move_generator.h"
+#include "time_manager.h"
+#include "transposition_table.h"
+
+struct SearchLimits
+{
+    int depth = MaxSearchDepth;
+    uint64_t nodes = 0;       // 0 for no node limit
+    long long moveTimeMs = 0; // Budget for this move, 0 for no time limit
+    bool fixedTime = false;   // Use all of moveTimeMs rather than stopping once the best move settles
+    bool infinite = false;    // Keep searching until stop(), even past the depth limit or a found mate
+    bool ponder = false;      // Search without limits until ponderhit() switches the others on
+};
+
+// Result of one finished iteration
+struct SearchInfo
+{
+    int depth = 0;
+    int selDepth = 0; // Deepest ply reached, quiescence included
+    int score = 0;
+    Move bestMove;
+    std::vector<Move> pv;
+    uint64_t nodes = 0;
+    long long timeMs = 0;
+    int hashfull = 0;
+};
+
+class Search;
+
+// Scores indexed by the moving piece (pieceIndex) and its destination square
+using PieceToHistory = int[12][64];
+
+// What one search thread remembers about each ply on the way to the current node
+struct SearchStackEntry
+{
+    Move move;                    // Move made at this ply, none for a null move
+    PieceToHistory *continuation; // Continuation history for that move, indexed by the reply
+};
+
+// Half width of the first aspiration window around the previous iteration's score, and the
+// depth from which that score is trusted enough to use one
+constexpr int AspirationDelta = 25;
+constexpr int AspirationMinDepth = 4;
+
+// Null-move pruning is tried from NullMoveMinDepth. From NullMoveVerifyDepth, or when the side to
+// move has no more than a rook's worth of pieces (where zugzwang is likely), a null move cutoff
+// is only trusted once a reduced search without null moves confirms it
+constexpr int NullMoveMinDepth = 3;
+constexpr int NullMoveVerifyDepth = 10;
+
+// Late move reductions apply to quiet moves from LmrMinDepth, after the first LmrMinMoves
+constexpr int LmrMinDepth = 3;
+constexpr int LmrMinMoves = 3;
+
+// History scores stay within +-HistoryMax. Each HistoryLmrDivisor of score takes a ply off
+// (or adds one to) a late move's reduction
+constexpr int HistoryMax = 16384;
+constexpr int HistoryLmrDivisor = 8192;
+
+// One search thread. It owns a private copy of the position, so threads never touch each
+// other's boards, and only meet through the shared transposition table
+class SearchWorker
+{
+public:
+    SearchWorker(Search &owner, int id) : id(id), owner(owner) {}
+
+    Board board;
+    const int id;
+
+    // Relaxed atomic so other threads can read a running total while this one searches
+    std::atomic<uint64_t> nodes{0};
+
+    // Result of the deepest iteration this worker finished
+    int completedDepth = 0;
+    Move bestMove;
+    int bestValue = -InfinityScore;
+    std::vector<Move> bestPv;
+
+    int selDepth = 0;
+
+    // Beta cutoffs in search(), and how many of them came from the first move tried: a measure
+    // of move ordering
+    uint64_t cutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+
+    void iterativeDeepening();
+
+    // One iteration at the root within (alpha, beta). previousBest is searched first with the
+    // full window, the rest with a null window. value is alpha on a fail low, at least beta on a
+    // fail high. Returns the move that raised alpha last, none if no move did (a fail low, or an
+    // abort before any move finished)
+    Move searchRoot(MoveList &moves, int depth, Move previousBest, int alpha, int beta, int &value);
+
+    int search(int depth, int alpha, int beta, int ply);
+    int pvsSearch(int depth, int alpha, int beta, int ply, int reduction = 0);
+    int searchAllCaptures(int alpha, int beta, int ply);
+
+    // ttMove, the best move stored for this position, is searched first, then captures and
+    // promotions by MVV-LVA, then this ply's killers, then other quiet moves by history
+    void orderMoves(MoveList &moves, Move ttMove, int ply);
+
+    // Mate scores are stored relative to the node rather than the root, so they stay
+    // correct when the same position is reached at a different ply
+    static int scoreToTT(int score, int ply);
+    static int scoreFromTT(int score, int ply);
+
+private:
+    Search &owner;
+
+    // Triangular PV table: pv[ply] holds the best line found from ply onwards, in
+    // entries ply to pvLength[ply] - 1
+    Move pv[MaxPly + 1][MaxPly + 1];
+    int pvLength[MaxPly + 1] = {};
+
+    void updatePv(int ply, Move move);
+
+    // stack[ply], with two sentinel entries in front so stack[ply - 2] is always valid.
+    // Sentinels and null moves point their continuation at emptyContinuation
+    SearchStackEntry stackStorage[MaxPly + 3];
+    SearchStackEntry *const stack = stackStorage + 2;
+
+    void pushStack(int ply, Move move);
+
+    // Two most recent quiet moves that caused a beta cutoff at each ply. Sibling positions
+    // tend to be refuted by the same move
+    Move killers[MaxPly + 1][2];
+
+    // Butterfly history: [colour][from][to], how often a quiet move caused a cutoff, less how
+    // often it was searched before another move that did
+    int history[2][64][64];
+
+    // Gravity update: the bonus shrinks as the entry nears HistoryMax, so scores stay bounded
+    // and recent results outweigh old ones
+    static void updateHistory(int &entry, int bonus) { entry += bonus - entry * std::abs(bonus) / HistoryMax; }
+
+    // Continuation history: [piece][to] of the previous move, then [piece][to] of this one.
+    // Searched one and two plies after a move, so a reply is scored by how well it answered
+    // the same move before, and by how well it followed up our own previous move
+    PieceToHistory continuationHistory[12][64];
+    PieceToHistory emptyContinuation;
+
+    // Capture history: [piece][to][captured type]
+    int captureHistory[12][64][6];
+
+    // Colour and type in one index, white pieces first
+    static int pieceIndex(const Piece &piece) { return piece.type + (piece.isWhite ? 0 : 6); }
+
+    // Type of the piece move would capture, None if it's not a capture
+    PieceType capturedType(Move move) const { return move.isEnPassant() ? Pawn : board.pieces[move.to()].type; }
+
+    // Quiet history of move for the side to move at ply: butterfly plus both continuations,
+    // within +-2 * HistoryMax
+    int quietHistory(Move move, int ply) const;
+
+    void clearHistory();
+
+    // A move caused a beta cutoff. It gains history of its kind (and a killer slot if quiet),
+    // and the moves tried before it lose some
+    void updateCutoffStats(Move move, const MoveList &quietsTried, const MoveList &capturesTried, int depth, int ply);
+
+    // Null moves are off below this ply while a verification search is running
+    int nullMoveMinPly = 0;
+
+    // Returns true if passing the turn still fails high, so the node can be cut
+    bool nullMovePrunes(int depth, int beta, int ply);
+
+    bool checkAbort();
+    void checkPonderhit();
+};
+
+// Lazy SMP: every thread runs the same iterative deepening search on its own copy of the
+// position. Helpers fill the shared TT with results the main thread (worker 0) then hits,
+// and the main thread alone watches the clock and decides when everyone stops
+class Search
+{
+public:
+    Search() { setThreads(1); }
+    ~Search() { wait(); }
+
+    void setThreads(int count);
+    int threadCount() const { return int(workers.size()); }
+
+    // Search on every thread and block until the limits are reached. Returns the best move
+    Move go(const Board &board, const SearchLimits &searchLimits);
+
+    // Non-blocking version of go. Call wait() to join the threads, then read bestWorker()
+    void start(const Board &board, const SearchLimits &searchLimits);
+    void wait();
+
+    // Safe to call from any thread
+    void stop() { stopFlag.store(true, std::memory_order_relaxed); }
+    bool stopped() const { return stopFlag.load(std::memory_order_relaxed); }
+
+    // The opponent played the move we were pondering on: start the clock from now.
+    // Safe to call from any thread
+    void ponderhit() { ponderhitFlag.store(true, std::memory_order_relaxed); }
+
+    // Worker whose deepest finished iteration should be trusted, ties going to the main thread
+    const SearchWorker &bestWorker() const;
+
+    // Total across all threads, may be read while searching
+    uint64_t nodes() const;
+
+    SearchLimits limits;
+    TimeManager timeManager;
+
+    // Called on the main search thread after each iteration it finishes
+    std::function<void(const SearchInfo &)> onIteration;
+
+private:
+    std::vector<std::unique_ptr<SearchWorker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopFlag{false};
+    std::atomic<bool> ponderhitFlag{false};
+
+    // Only read and written by the main worker once the search has started
+    bool pondering = false;
+
+    friend class SearchWorker;
+};
+
+// The engine's thread pool
+inline Search Searcher;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <stddef.h>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Neither side ever blocks: push fails when the queue is full, pop when it is empty
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer side
+    bool push(const T &item)
+    {
+        const size_t tail = tailIndex.load(std::memory_order_relaxed);
+
+        if (tail - headIndex.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        buffer[tail & (Capacity - 1)] = item;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &item)
+    {
+        const size_t head = headIndex.load(std::memory_order_relaxed);
+
+        if (head == tailIndex.load(std::memory_order_acquire))
+            return false;
+
+        item = buffer[head & (Capacity - 1)];
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> buffer{};
+
+    // On separate cache lines so the two threads don't keep stealing one line from each other
+    alignas(64) std::atomic<size_t> headIndex{0};
+    alignas(64) std::atomic<size_t> tailIndex{0};
+};
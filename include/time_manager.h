@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+// Wall-clock budget for one move. The hard limit aborts a search in progress, the soft limit
+// only decides whether another iterative deepening iteration is worth starting
+class TimeManager
+{
+public:
+    // A budget of 0 or less means no time limit. With fixedTime the whole budget is used,
+    // and the soft limit never stops the search early
+    void start(long long budgetMs, bool fixedTime = false)
+    {
+        startTime = std::chrono::steady_clock::now();
+        limited = budgetMs > 0;
+        fixed = fixedTime;
+        hardLimitMs = budgetMs;
+
+        // Each iteration usually takes a few times longer than the one before,
+        // so one started after half the budget would rarely finish
+        softLimitMs = budgetMs / 2;
+    }
+
+    // Budget for one move from a game clock: aims to spend timeLeft / movesToGo plus most of
+    // the increment (the soft limit), allowing up to twice that while the best move is unsettled
+    static long long budgetFromClock(long long timeLeftMs, long long incrementMs, int movesToGo)
+    {
+        // Kept back for the GUI to receive the move
+        const long long MoveOverheadMs = 30;
+
+        if (movesToGo <= 0)
+            movesToGo = 30;
+
+        const long long target = timeLeftMs / movesToGo + incrementMs * 3 / 4;
+        long long budget = std::min(target * 2, std::max(timeLeftMs / 3, target));
+
+        budget = std::min(budget, timeLeftMs - MoveOverheadMs);
+        return std::max(budget, 1LL);
+    }
+
+    long long elapsedMs() const
+    {
+        auto elapsed = std::chrono::steady_clock::now() - startTime;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    }
+
+    bool hardLimitReached() const
+    {
+        return limited && elapsedMs() >= hardLimitMs;
+    }
+
+    // stableIterations counts how many iterations in a row returned the same best move.
+    // A best move that keeps changing earns more of the budget, a settled one gives time back
+    bool softLimitReached(int stableIterations) const
+    {
+        static constexpr int scalePercent[] = {150, 110, 90, 70, 50};
+
+        if (!limited || fixed)
+            return false;
+
+        return elapsedMs() * 100 >= softLimitMs * scalePercent[std::min(stableIterations, 4)];
+    }
+
+private:
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    bool limited = false;
+    bool fixed = false;
+    long long softLimitMs = 0;
+    long long hardLimitMs = 0;
+};
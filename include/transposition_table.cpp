@@ -0,0 +1,102 @@
+#include <cstring>
+
+#include "transposition_table.h"
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    clusterCount = megabytes * 1024 * 1024 / sizeof(Cluster);
+    if (clusterCount == 0)
+        clusterCount = 1;
+
+    clusters.reset(new Cluster[clusterCount]);
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    std::memset(static_cast<void *>(clusters.get()), 0, clusterCount * sizeof(Cluster));
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData &data) const
+{
+    const Cluster *cluster = clusterFor(key);
+
+    for (const Entry &slot : cluster->entries)
+    {
+        const EntryData entry = load(slot);
+
+        if (entry.key == key && entry.bound() != BoundNone)
+        {
+            data.move = entry.move();
+            data.score = entry.score();
+            data.depth = entry.depth();
+            data.bound = entry.bound();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound)
+{
+    Cluster *cluster = clusterFor(key);
+    Entry *replace = &cluster->entries[0];
+    EntryData old = load(*replace);
+
+    for (Entry &slot : cluster->entries)
+    {
+        const EntryData entry = load(slot);
+
+        // Reuse this position's own slot, or an empty one
+        if (entry.key == key || entry.bound() == BoundNone)
+        {
+            replace = &slot;
+            old = entry;
+            break;
+        }
+
+        // Otherwise evict the shallowest entry, treating each search of age as 2 plies of depth
+        if (entry.depth() - 2 * relativeAge(entry) < old.depth() - 2 * relativeAge(old))
+        {
+            replace = &slot;
+            old = entry;
+        }
+    }
+
+    // Don't let a shallow non-exact result overwrite a deeper one for the same position
+    if (old.key == key && bound != BoundExact && depth + 3 < old.depth())
+        return;
+
+    // Keep the old best move if this search didn't find one
+    if (move == Move::none() && old.key == key)
+        move = old.move();
+
+    const uint64_t data = uint64_t(move.data) |
+                          uint64_t(uint16_t(int16_t(score))) << 16 |
+                          uint64_t(uint8_t(depth)) << 32 |
+                          uint64_t(uint8_t(generation | bound)) << 40;
+
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const
+{
+    const size_t sampled = clusterCount < 1000 ? clusterCount : 1000;
+    int used = 0;
+
+    for (size_t i = 0; i < sampled; i++)
+    {
+        for (const Entry &slot : clusters[i].entries)
+        {
+            const EntryData entry = load(slot);
+
+            if (entry.bound() != BoundNone && (entry.genBound() & GenerationMask) == generation)
+                used++;
+        }
+    }
+
+    return int(used * 1000 / (sampled * ClusterSize));
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "move_generator.h"
+
+enum Bound
+{
+    BoundNone = 0,
+    BoundUpper = 1, // Score is at most this (failed low)
+    BoundLower = 2, // Score is at least this (failed high)
+    BoundExact = 3,
+};
+
+// What a probe hands back. Scores are stored as given: mate scores must be made
+// relative to the stored node by the caller (see SearchWorker::scoreToTT / scoreFromTT in search.h)
+struct TTData
+{
+    Move move;
+    int score = 0;
+    int depth = 0;
+    Bound bound = BoundNone;
+};
+
+class TranspositionTable
+{
+public:
+    static constexpr size_t DefaultSizeMB = 16;
+
+    TranspositionTable() { resize(DefaultSizeMB); }
+
+    // Reallocates and clears the table. Must not be called while a search is running.
+    // probe and store, on the other hand, may be called from any number of threads at once
+    void resize(size_t megabytes);
+    void clear();
+
+    // Called once per root search so entries from older searches age out first
+    void newSearch() { generation += GenerationDelta; }
+
+    bool probe(uint64_t key, TTData &data) const;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound);
+
+    // Permille of sampled entries written by the current search, for UCI "hashfull"
+    int hashfull() const;
+
+    size_t sizeMB() const { return clusterCount * sizeof(Cluster) / (1024 * 1024); }
+
+private:
+    // 16 bytes: everything but the key packed into one data word, move (bits 0-15), score (16-31),
+    // depth (32-39), generation and bound (40-47), and the key XORed with that word.
+    // Threads read and write the two words without locking, so another thread's store can land
+    // between them. The XOR makes such a torn entry fail the key check instead of being trusted
+    struct Entry
+    {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    // A consistent copy of one entry, read once
+    struct EntryData
+    {
+        uint64_t key;
+        uint64_t data;
+
+        Move move() const { return Move(uint16_t(data)); }
+        int score() const { return int16_t(data >> 16); }
+        int depth() const { return uint8_t(data >> 32); }
+        uint8_t genBound() const { return uint8_t(data >> 40); }
+        Bound bound() const { return Bound(genBound() & 3); }
+    };
+
+    static EntryData load(const Entry &entry)
+    {
+        const uint64_t data = entry.data.load(std::memory_order_relaxed);
+        return {entry.keyXorData.load(std::memory_order_relaxed) ^ data, data};
+    }
+
+    static constexpr int ClusterSize = 4;
+
+    // Generation lives in the top 6 bits of the genBound byte, the bound in the bottom 2
+    static constexpr uint8_t GenerationDelta = 4;
+    static constexpr uint8_t GenerationMask = 0xFC;
+
+    // Added before subtracting so the bound bits can't borrow from the generation bits,
+    // and the difference wraps correctly once the generation counter overflows
+    static constexpr int GenerationCycle = 255 + GenerationDelta;
+
+    // One cache line, so a probe touches a single line of memory
+    struct alignas(64) Cluster
+    {
+        Entry entries[ClusterSize];
+    };
+
+    static_assert(sizeof(Cluster) == 64, "cluster must fill exactly one cache line");
+
+    Cluster *clusterFor(uint64_t key) const
+    {
+        // Map the key onto [0, clusterCount) with a multiply-high instead of a modulo
+        return &clusters[(unsigned __int128)key * clusterCount >> 64];
+    }
+
+    // How many searches ago an entry was written: 0 for the current search, 1 for the one before
+    int relativeAge(const EntryData &entry) const
+    {
+        return ((GenerationCycle + generation - entry.genBound()) & GenerationMask) / GenerationDelta;
+    }
+
+    std::unique_ptr<Cluster[]> clusters;
+    size_t clusterCount = 0;
+    // Only changed between searches, never while threads are probing
+    uint8_t generation = 0;
+};
+
+// Shared by every search thread
+inline TranspositionTable TT;
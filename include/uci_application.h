@@ -0,0 +1,329 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "bench.h"
+#include "board.h"
+#include "engine.h"
+#include "perft.h"
+#include "search.h"
+#include "time_manager.h"
+#include "transposition_table.h"
+
+// Speaks the UCI protocol on stdin/stdout. A reader thread takes lines as they arrive and acts
+// on stop, ponderhit and quit straight away, even while the command loop is blocked waiting for
+// a search to end before it can change the position or an option. The command loop then handles
+// every line in order, those included, and searches run on the engine thread
+class UciApplication
+{
+public:
+    void run()
+    {
+        MoveGen::precomputeMoveData();
+        board.loadFen(StartFen);
+
+        std::thread reader([this] { readInput(); });
+
+        std::string line;
+        while (nextLine(line))
+        {
+            std::istringstream stream(line);
+            std::string command;
+            stream >> command;
+
+            if (command == "quit")
+                break;
+
+            handleCommand(command, stream);
+        }
+
+        engine.stop();
+        engine.waitUntilIdle();
+        reader.join();
+    }
+
+private:
+    Board board;
+
+    std::mutex outputMutex;
+
+    std::mutex inputMutex;
+    std::condition_variable inputReady;
+    std::deque<std::string> inputLines;
+
+    // Declared last so its thread never sees the members above half built
+    Engine engine = Engine([this](const EngineEvent &event) { onEngineEvent(event); });
+
+    void readInput()
+    {
+        std::string line;
+
+        while (std::getline(std::cin, line))
+        {
+            std::istringstream stream(line);
+            std::string command;
+            stream >> command;
+
+            if (command == "stop" || command == "quit")
+                engine.stop();
+            else if (command == "ponderhit")
+                engine.ponderhit();
+
+            pushLine(line);
+
+            if (command == "quit")
+                return;
+        }
+
+        // End of input means the GUI is gone
+        engine.stop();
+        pushLine("quit");
+    }
+
+    void pushLine(const std::string &line)
+    {
+        {
+            std::lock_guard<std::mutex> lock(inputMutex);
+            inputLines.push_back(line);
+        }
+
+        inputReady.notify_one();
+    }
+
+    bool nextLine(std::string &line)
+    {
+        std::unique_lock<std::mutex> lock(inputMutex);
+        inputReady.wait(lock, [this] { return !inputLines.empty(); });
+
+        line = inputLines.front();
+        inputLines.pop_front();
+        return true;
+    }
+
+    void send(const std::string &text)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << text << std::endl;
+    }
+
+    void handleCommand(const std::string &command, std::istringstream &stream)
+    {
+        if (command == "uci")
+        {
+            send("id name chess\n"
+                 "id author duckquypuf\n"
+                 "option name Hash type spin default " + std::to_string(TranspositionTable::DefaultSizeMB) + " min 1 max 65536\n"
+                 "option name Threads type spin default 1 min 1 max 256\n"
+                 "option name Ponder type check default false\n"
+                 "uciok");
+        }
+        else if (command == "isready")
+        {
+            send("readyok");
+        }
+        else if (command == "ucinewgame")
+        {
+            engine.waitUntilIdle();
+            TT.clear();
+        }
+        else if (command == "setoption")
+        {
+            engine.waitUntilIdle();
+            setOption(stream);
+        }
+        else if (command == "position")
+        {
+            engine.waitUntilIdle();
+            setPosition(stream);
+        }
+        else if (command == "go")
+        {
+            engine.waitUntilIdle();
+            go(stream);
+        }
+        else if (command == "bench")
+        {
+            int depth = Bench::DefaultDepth;
+            stream >> depth;
+
+            engine.waitUntilIdle();
+            Bench::run(depth);
+        }
+        else if (command == "perft")
+        {
+            // perft <depth> [hash <mb>] [fen]. Counts from the current position, or from the FEN,
+            // on as many threads as the Threads option
+            int depth = 1;
+            size_t hashMB = 0;
+            std::string token, fen;
+            stream >> depth;
+            while (stream >> token)
+            {
+                if (token == "hash" && fen.empty())
+                    stream >> hashMB;
+                else
+                    fen += token + " ";
+            }
+
+            engine.waitUntilIdle();
+            if (!fen.empty())
+                Perft::run(depth, fen, Searcher.threadCount(), hashMB);
+            else if (hashMB)
+            {
+                PerftTable table(hashMB);
+                Perft::divide(board, std::max(depth, 1), Searcher.threadCount(), &table);
+            }
+            else
+                Perft::divide(board, std::max(depth, 1), Searcher.threadCount());
+        }
+        else if (command == "stop")
+        {
+            engine.stop();
+        }
+        else if (command == "ponderhit")
+        {
+            engine.ponderhit();
+        }
+    }
+
+    // setoption name <id> value <x>
+    void setOption(std::istringstream &stream)
+    {
+        std::string token, name, value;
+
+        stream >> token >> name >> token >> value;
+
+        if (name == "Hash")
+            TT.resize(std::max(1, std::atoi(value.c_str())));
+        else if (name == "Threads")
+            Searcher.setThreads(std::max(1, std::atoi(value.c_str())));
+    }
+
+    // position [startpos | fen <fen>] [moves <move>...]
+    void setPosition(std::istringstream &stream)
+    {
+        std::string token, fen;
+
+        stream >> token;
+
+        if (token == "startpos")
+        {
+            fen = StartFen;
+            stream >> token;
+        }
+        else if (token == "fen")
+        {
+            while (stream >> token && token != "moves")
+                fen += token + " ";
+        }
+        else
+        {
+            return;
+        }
+
+        if (!board.loadFen(fen))
+            return;
+
+        while (stream >> token)
+        {
+            const Move move = board.parseUciMove(token);
+
+            if (move == Move::none())
+                break;
+
+            board.makeMove(move);
+        }
+    }
+
+    void go(std::istringstream &stream)
+    {
+        SearchLimits limits;
+        std::string token;
+        long long timeLeft[2] = {0, 0};
+        long long increment[2] = {0, 0};
+        int movesToGo = 0;
+        bool clock = false;
+
+        while (stream >> token)
+        {
+            if (token == "depth")
+                stream >> limits.depth;
+            else if (token == "nodes")
+                stream >> limits.nodes;
+            else if (token == "movetime")
+            {
+                stream >> limits.moveTimeMs;
+                limits.fixedTime = true;
+            }
+            else if (token == "wtime" || token == "btime")
+            {
+                stream >> timeLeft[token == "wtime" ? White : Black];
+                clock = true;
+            }
+            else if (token == "winc")
+                stream >> increment[White];
+            else if (token == "binc")
+                stream >> increment[Black];
+            else if (token == "movestogo")
+                stream >> movesToGo;
+            else if (token == "infinite")
+                limits.infinite = true;
+            else if (token == "ponder")
+                limits.ponder = true;
+        }
+
+        const int us = board.isWhiteTurn ? White : Black;
+
+        if (clock && !limits.fixedTime)
+            limits.moveTimeMs = TimeManager::budgetFromClock(timeLeft[us], increment[us], movesToGo);
+
+        engine.requestSearch(board, limits);
+    }
+
+    // Runs on the search threads
+    void onEngineEvent(const EngineEvent &event)
+    {
+        const SearchInfo &info = event.info;
+
+        if (event.type == EngineEventType::Progress)
+        {
+            send(infoLine(info));
+            return;
+        }
+
+        std::string line = "bestmove " + board.moveToUci(info.bestMove);
+
+        if (info.pv.size() > 1)
+            line += " ponder " + board.moveToUci(info.pv[1]);
+
+        send(line);
+    }
+
+    std::string infoLine(const SearchInfo &info) const
+    {
+        std::ostringstream line;
+
+        line << "info depth " << info.depth << " seldepth " << info.selDepth << " score ";
+
+        if (info.score >= MateThreshold)
+            line << "mate " << (MateScore - info.score + 1) / 2;
+        else if (info.score <= -MateThreshold)
+            line << "mate -" << (MateScore + info.score) / 2;
+        else
+            line << "cp " << info.score;
+
+        line << " nodes " << info.nodes << " nps " << info.nodes * 1000 / std::max(info.timeMs, 1LL)
+             << " hashfull " << info.hashfull << " time " << info.timeMs << " pv";
+
+        for (const Move &move : info.pv)
+            line << " " << board.moveToUci(move);
+
+        return line.str();
+    }
+};
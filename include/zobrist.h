@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+
+// Random keys XORed together to form a position's hash. Generated at compile time from a
+// fixed seed, so keys (and anything stored under them) are identical across runs and builds
+namespace Zobrist
+{
+    inline constexpr uint64_t splitMix64(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    struct Keys
+    {
+        uint64_t pieces[2][6][64] = {}; // [colour][PieceType][square], also indexed by piece count for material keys
+        uint64_t castling[16] = {};     // One per castling rights mask
+        uint64_t enPassant[8] = {};     // By file
+        uint64_t blackToMove = 0;
+    };
+
+    inline constexpr Keys keys = []
+    {
+        Keys k{};
+        uint64_t state = 0x1070372ULL;
+
+        for (auto &colour : k.pieces)
+            for (auto &type : colour)
+                for (uint64_t &key : type)
+                    key = splitMix64(state);
+
+        for (uint64_t &key : k.castling)
+            key = splitMix64(state);
+
+        for (uint64_t &key : k.enPassant)
+            key = splitMix64(state);
+
+        k.blackToMove = splitMix64(state);
+
+        return k;
+    }();
+};
@@ -0,0 +1,35 @@
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "perft_suite.h"
+
+// perft_suite [epd file] [--depth <max>] [--threads <n>]
+// Exits with 1 on any mismatch, so it can gate a build
+int main(int argc, char **argv)
+{
+    std::string path = "../assets/perft.epd";
+    int maxDepth = 0;
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--depth" && i + 1 < argc)
+            maxDepth = std::atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::atoi(argv[++i]);
+        else
+            path = arg;
+    }
+
+    MoveGen::precomputeMoveData();
+
+    PerftSuite suite;
+    if (!suite.load(path))
+        return 1;
+
+    return suite.run(threads, maxDepth) ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#include <cstdlib>
+#include <string>
+
+#include "chess_tester.h"
+
+// chess_tester [--depth <n>] [--runs <n>] [--json <out>] [--compare <previous>] [--threshold <percent>]
+// Exits with 1 if the comparison finds a regression
+int main(int argc, char **argv)
+{
+    int depth = 6;
+    int runs = 5;
+    double threshold = 5.0;
+    std::string jsonPath, comparePath;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--depth")
+            depth = std::atoi(argv[i + 1]);
+        else if (arg == "--runs")
+            runs = std::atoi(argv[i + 1]);
+        else if (arg == "--json")
+            jsonPath = argv[i + 1];
+        else if (arg == "--compare")
+            comparePath = argv[i + 1];
+        else if (arg == "--threshold")
+            threshold = std::atof(argv[i + 1]);
+    }
+
+    MoveGen::precomputeMoveData();
+
+    ChessTester tester;
+    tester.runAllTests(std::max(depth, 1), std::max(runs, 1));
+    tester.printResults();
+
+    bool passed = true;
+
+    if (!comparePath.empty())
+        passed = tester.compareWithPrevious(comparePath, threshold);
+
+    if (!jsonPath.empty())
+        tester.exportToJSON(jsonPath, runs);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "bench.h"
+#include "perft.h"
+#include "uci_application.h"
+
+// "chess_uci bench [depth]" runs the benchmark and "chess_uci perft <depth> [hash <mb>] [fen]"
+// counts moves on every hardware thread, both then exit. Anything else starts the UCI loop
+int main(int argc, char **argv)
+{
+    if (argc > 1 && std::string(argv[1]) == "bench")
+    {
+        MoveGen::precomputeMoveData();
+        Bench::run(argc > 2 ? std::atoi(argv[2]) : Bench::DefaultDepth);
+        return 0;
+    }
+
+    if (argc > 2 && std::string(argv[1]) == "perft")
+    {
+        std::string fen;
+        size_t hashMB = 0;
+        for (int i = 3; i < argc; i++)
+        {
+            if (std::string(argv[i]) == "hash" && fen.empty() && i + 1 < argc)
+                hashMB = std::atoi(argv[++i]);
+            else
+                fen += std::string(argv[i]) + " ";
+        }
+
+        MoveGen::precomputeMoveData();
+        const int threads = std::max(1, (int)std::thread::hardware_concurrency());
+        return Perft::run(std::atoi(argv[2]), fen, threads, hashMB) ? 0 : 1;
+    }
+
+    UciApplication app;
+    app.run();
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+
+#include "transposition_table.h"
+
+// Replacement must prefer entries from earlier searches over ones from the current search
+int main()
+{
+    TranspositionTable table;
+
+    // 0 MB rounds up to a single cluster, so every key competes for the same four slots
+    table.resize(0);
+
+    for (uint64_t key = 1; key <= 4; key++)
+        table.store(key, Move::none(), 0, 2, BoundExact);
+
+    table.newSearch();
+
+    // Each new entry has to evict one of the previous search's entries, never the other new one
+    table.store(100, Move::none(), 0, 2, BoundExact);
+    table.store(200, Move::none(), 0, 2, BoundExact);
+
+    TTData data;
+    int failures = 0;
+
+    for (uint64_t key : {100, 200})
+    {
+        if (!table.probe(key, data))
+        {
+            std::cout << "FAIL: current search entry " << key << " was replaced" << std::endl;
+            failures++;
+        }
+    }
+
+    int survivors = 0;
+    for (uint64_t key = 1; key <= 4; key++)
+        survivors += table.probe(key, data);
+
+    if (survivors != 2)
+    {
+        std::cout << "FAIL: expected 2 previous search entries left, found " << survivors << std::endl;
+        failures++;
+    }
+
+    if (failures == 0)
+        std::cout << "OK" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}